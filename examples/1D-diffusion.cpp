@@ -37,6 +37,7 @@ void simulation(int nCells, int nSteps, double leftX, double rightX,
   auto fl = rise(buf).map(stencil).colsResult().reduce<1>(sum(), 0.).inprocess()
               .reduce<1>(sum(), 0.).prll(1.).partitionBy(range(nCells)).build();
   for (auto i = 0; i < nSteps; ++i) {
+    // output of the step is moved in as the input of next, without a copy.
     buf.buffer(flow(fl).get());
   }
   rise(buf).dump("final").run();
@@ -55,6 +55,7 @@ void demoFromFile() {
           .strictSchema(false)  // select even if columns are less or more
                                 // filling with default value if cols are less.
                                 // ignoring cols if are more
+          .memoryMap()          // map file(s) in memory instead of streaming.
       )
       .dump(outFile, "\n -- two")
       .run();
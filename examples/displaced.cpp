@@ -20,7 +20,7 @@
 #include <ezl.hpp>
 #include <ezl/algorithms/predicates.hpp>
 #include <ezl/algorithms/reduces.hpp>
-#include <ezl/algorithms/fromFile.hpp>
+#include <ezl/algorithms/fromLammps.hpp>
 
 auto calcDist(std::array<float, 3> p1, std::array<float, 3> p2) {
   auto diff = 0.0F;
@@ -54,18 +54,16 @@ void displaced(int argc, char* argv[]) {
   };
 
   // loading first frame atoms in the memory partitioned on atoms-id.
-  auto buffer = ezl::rise(ezl::fromFile<int, array<float, 3>, int>(firstFile)
-                            .cols({1, 3, 4, 5, 6})  // id, coords
-                            .lammps())
+  auto buffer = ezl::rise(ezl::fromLammps<int, array<float, 3>, int>(firstFile)
+                            .cols({1, 3, 4, 5}))  // id, coords
                   .filter(ezl::tautology()).partitionBy<1>().prll(1.)
                   .get();
 
   boost::unordered_map<int, array<float, 3>> firstFrame;
   for(const auto& it :buffer) firstFrame[std::get<0>(it)] = std::get<1>(it);
 
-  ezl::rise(ezl::fromFile<int, array<float, 3>, int>(allFiles)
-                .cols({1, 3, 4, 5, 6}) // id, coords, timestep
-                .lammps())
+  ezl::rise(ezl::fromLammps<int, array<float, 3>, int>(allFiles)
+                .cols({1, 3, 4, 5})) // id, coords, timestep
       .map<1, 2>([&firstFrame](int id, array<float, 3> coords) {
         return calcDist(coords, firstFrame[id]);
       }).partitionBy<1>().prll(1.).colsTransform()
@@ -0,0 +1,237 @@
+/*!
+ * @file
+ * fromFileBench: throughput of reading and parsing with fromFile per process.
+ *
+ * command to run:
+ * mpirun -n 2 ./bin/fromFileBench 256
+ *
+ * The command line argument is the size of input in MB to generate for each
+ * process (default 8). The rows have a count and three floats like the atom
+ * rows in lammps dumps. The column splitting is timed alone, with
+ * `boost::split` on a line string as done earlier in `FromFile` and with the
+ * vectorized `DelimSet` on the views. The conversion of the columns is timed
+ * per type with `boost::lexical_cast` as done earlier in `lexCastTuple` and
+ * with the parsers that it uses now. Then the file is read with fromFile
+ * streaming, with read-ahead prefetch, memory mapped and with a thread per
+ * core. At last the rows are dumped with dumpBinary and read with fromBinary,
+ * as in chaining dataflows through files.
+ *
+ * benchmarks at the bottom
+ * */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/fromBinary.hpp>
+#include <ezl/algorithms/fromFile.hpp>
+#include <ezl/helper/DelimSet.hpp>
+#include <ezl/helper/meta/lexCastTuple.hpp>
+
+template <class F>
+double timeIt(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+  return secs.count();
+}
+
+std::string generate(size_t bytes, unsigned seed) {
+  std::mt19937 gen{seed};
+  std::uniform_real_distribution<float> dis{-100.F, 100.F};
+  std::string data;
+  data.reserve(bytes + 128);
+  char row[128];
+  for (auto id = 0LL; data.size() < bytes; ++id) {
+    auto n = std::snprintf(row, sizeof(row), "%lld %f %f %f\n", id, dis(gen),
+                           dis(gen), dis(gen));
+    data.append(row, n);
+  }
+  return data;
+}
+
+// MB/s of converting the columns to type T with lexical_cast and parseField.
+template <class T>
+std::string castBench(const std::vector<ezl::detail::CharRange>& cols) {
+  size_t bytes = 0;
+  for (const auto& it : cols) bytes += it.size();
+  auto mbps = [bytes](double secs) {
+    return std::to_string(int(bytes / secs / (1 << 20)));
+  };
+  T sum[2] = {T(), T()};
+  auto tLexical = timeIt([&] {
+    for (const auto& it : cols) {
+      sum[0] += boost::lexical_cast<T>(it.begin(), it.size());
+    }
+  });
+  auto tParse = timeIt([&] {
+    T val;
+    for (const auto& it : cols) {
+      if (!ezl::detail::meta::parseField(it.begin(), it.end(), val)) {
+        throw std::runtime_error("conversion failed.");
+      }
+      sum[1] += val;
+    }
+  });
+  if (sum[0] != sum[1]) throw std::runtime_error("conversion mismatch.");
+  return "lexical_cast " + mbps(tLexical) + ", parseField " + mbps(tParse) +
+         " MB/s";
+}
+
+void fromFileBench(int argc, char* argv[]) {
+  using std::string;
+  using std::vector;
+
+  size_t mb = 8;
+  if (argc > 1) mb = std::stoul(argv[1]);
+  auto& karta = ezl::Karta::inst();
+  const string fname = "fromFileBench_" + std::to_string(karta.rank()) + ".txt";
+  const auto data = generate(mb << 20, karta.rank());
+  std::ofstream(fname) << data;
+  auto mbps = [&data](double secs) {
+    return std::to_string(int(data.size() / secs / (1 << 20))) + " MB/s";
+  };
+
+  size_t nCols = 0;
+  auto tBoost = timeIt([&] {
+    auto it = data.data();
+    auto last = data.data() + data.size();
+    while (it != last) {
+      auto end = std::find(it, last, '\n');
+      string line(it, end);
+      vector<string> vstr;
+      boost::split(vstr, line, boost::is_any_of(" "), boost::token_compress_on);
+      nCols += vstr.size();
+      it = (end == last) ? last : end + 1;
+    }
+  });
+  auto tSimd = timeIt([&] {
+    ezl::detail::DelimSet rows{"\n"};
+    ezl::detail::DelimSet cols{" "};
+    vector<ezl::detail::CharRange> tokens;
+    auto it = data.data();
+    auto last = data.data() + data.size();
+    while (it != last) {
+      auto end = rows.find(it, last);
+      tokens.clear();
+      cols.tokens(it, end, [&tokens](const char* b, const char* e) {
+        tokens.emplace_back(b, e);
+        return true;
+      });
+      nCols -= tokens.size();
+      it = (end == last) ? last : end + 1;
+    }
+  });
+  if (nCols != 0) throw std::runtime_error("column splitting mismatch.");
+  karta.print("split boost::split: " + mbps(tBoost) + ", DelimSet: " + mbps(tSimd));
+
+  // first column is integer and the rest are reals.
+  vector<ezl::detail::CharRange> ints, reals;
+  size_t nCol = 0;
+  ezl::detail::DelimSet{" \n"}.tokens(data.data(), data.data() + data.size(),
+      [&](const char* b, const char* e) {
+        ((nCol++ % 4) ? reals : ints).emplace_back(b, e);
+        return true;
+      });
+  karta.print("int: " + castBench<int>(ints));
+  karta.print("long long: " + castBench<long long>(ints));
+  karta.print("float: " + castBench<float>(reals));
+  karta.print("double: " + castBench<double>(reals));
+
+  size_t nRows[2] = {0, 0};
+  auto tStream = timeIt([&] {
+    ezl::rise(ezl::fromFile<long long, float, float, float>(fname))
+      .filter<1>([&nRows](long long) { ++nRows[0]; return false; })
+      .run(0);
+  });
+  auto tMmap = timeIt([&] {
+    ezl::rise(ezl::fromFile<long long, float, float, float>(fname).memoryMap())
+      .filter<1>([&nRows](long long) { ++nRows[1]; return false; })
+      .run(0);
+  });
+  size_t nRowsPrefetch = 0;
+  auto tPrefetch = timeIt([&] {
+    ezl::rise(ezl::fromFile<long long, float, float, float>(fname).prefetch())
+      .filter<1>([&nRowsPrefetch](long long) { ++nRowsPrefetch; return false; })
+      .run(0);
+  });
+  size_t nThreads = std::max(std::thread::hardware_concurrency(), 2U);
+  size_t nRowsThreads = 0;
+  auto tThreads = timeIt([&] {
+    ezl::rise(ezl::fromFile<long long, float, float, float>(fname)
+              .threads(nThreads))
+      .filter<1>([&nRowsThreads](long long) { ++nRowsThreads; return false; })
+      .run(0);
+  });
+  const string bname = "fromFileBench_" + std::to_string(karta.rank()) + ".ezb";
+  std::remove(bname.c_str());
+  ezl::rise(ezl::fromFile<long long, float, float, float>(fname))
+    .dumpBinary(bname)
+    .run(0);
+  size_t nRowsBinary = 0;
+  auto tBinary = timeIt([&] {
+    ezl::rise(ezl::fromBinary<long long, float, float, float>(bname))
+      .filter<1>([&nRowsBinary](long long) { ++nRowsBinary; return false; })
+      .run(0);
+  });
+  std::remove(fname.c_str());
+  std::remove(bname.c_str());
+  if (nRows[0] != nRows[1] || nRows[0] != nRowsThreads ||
+      nRows[0] != nRowsPrefetch || nRows[0] != nRowsBinary) {
+    throw std::runtime_error("row count mismatch.");
+  }
+  karta.print("fromFile streaming: " + mbps(tStream) + ", prefetch: " +
+              mbps(tPrefetch) + ", memoryMap: " + mbps(tMmap) + ", threads(" + std::to_string(nThreads) + "): " +
+              mbps(tThreads));
+  karta.print("fromBinary: " + mbps(tBinary) + " (of text size)");
+}
+
+int main(int argc, char *argv[]) {
+  ezl::Env env{argc, argv, false};
+  try {
+    fromFileBench(argc, argv);
+  } catch (const std::exception& ex) {
+    std::cerr<<"error: "<<ex.what()<<'\n';
+    env.abort(1);
+  } catch (...) {
+    std::cerr<<"unknown exception\n";
+    env.abort(2);
+  }
+  return 0;
+}
+
+/*!
+ * benchmark results: Linux(single core); input: 128MB; units: MB/s
+ *  *column split*| boost::split | DelimSet |
+ *  ---           |---           |---       |
+ *  *sse2*        | 36           | 666      |
+ *  *avx2*        | 32           | 615      |
+ *
+ *  *conversion*  | lexical_cast | parseField |
+ *  ---           |---           |---         |
+ *  *int*         | 115          | 296        |
+ *  *long long*   | 106          | 307        |
+ *  *float*       | 11           | 212        |
+ *  *double*      | 10           | 251        |
+ *
+ *  *fromFile*    | streaming    | prefetch | memoryMap| threads(2) |
+ *  ---           |---           |---       |---       |---         |
+ *  *lexical_cast*| 10           | -        | 13       | -          |
+ *  *parseField*  | 71           | 154      | 182      | 169        |
+ *
+ * fromBinary reads the same rows from the dumpBinary file at 1956 MB/s of
+ * the size of the text input, i.e. chaining dataflows through binary files
+ * is limited by the disk rather than by the parsing.
+ *
+ * The input is in page cache here. Prefetch and threads on a single core
+ * only overlap reading with parsing, which matters more on network file
+ * systems. The parsing with threads scales with the cores of the process.
+ */
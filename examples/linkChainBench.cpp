@@ -0,0 +1,174 @@
+/*!
+ * @file
+ * linkChainBench: cost of passing rows through deep chains of units.
+ *
+ * command to run:
+ * ./bin/linkChainBench 32 4
+ *
+ * The command line arguments are the depth of the chain (default 16) and
+ * the number of rows in millions (default 1). The rows are passed through
+ * a chain of links that loop over the `std::map` of next units for every
+ * row as the units did earlier, and through a chain of `NoOp` units that
+ * pass a row with the contiguous list of next units, with a single call for
+ * a single next unit. Then the rows are passed through eight `Map` units
+ * linked one after another and through eight map expressions of a dataflow,
+ * that are fused in a single unit.
+ *
+ * benchmarks at the bottom
+ * */
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ezl.hpp>
+#include <ezl/units/Filter.hpp>
+#include <ezl/units/Map.hpp>
+#include <ezl/units/NoOp.hpp>
+
+template <class F>
+double timeIt(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+  return secs.count();
+}
+
+// link that passes a row by looping over the map of next units.
+template <class IO>
+struct MapHop : public ezl::Link<IO, IO> {
+  virtual void dataEvent(const IO& data) final override {
+    for (auto& it : this->next()) it.second->dataEvent(data);
+  }
+};
+
+// chain of `depth` links of type L, returns the first and the last.
+template <class L>
+auto chain(size_t depth) {
+  auto first = std::make_shared<L>();
+  std::shared_ptr<L> last = first;
+  for (size_t i = 1; i < depth; ++i) {
+    auto cur = std::make_shared<L>();
+    last->next(cur, last);
+    last = cur;
+  }
+  return std::make_pair(first, last);
+}
+
+void linkChainBench(int argc, char* argv[]) {
+  using std::tuple;
+  using namespace ezl::detail;
+  using I = tuple<const int&>;
+  using meta::slct;
+
+  size_t depth = 16;
+  size_t nRows = 1 << 20;
+  if (argc > 1) depth = std::stoul(argv[1]);
+  if (argc > 2) nRows = std::stoul(argv[2]) << 20;
+  if (depth < 1) depth = 1;
+  auto& karta = ezl::Karta::inst();
+  auto mrps = [nRows](double secs) {
+    char str[32];
+    std::snprintf(str, sizeof(str), "%.1f M rows/s", nRows / secs / 1e6);
+    return std::string{str};
+  };
+
+  long long sum[4] = {0, 0, 0, 0};
+  auto count = [&sum](int k) {
+    return [&sum, k](int i) {
+      sum[k] += i;
+      return false;
+    };
+  };
+  auto pass = [nRows](auto& first) {
+    for (int i = 0; i < int(nRows); ++i) first->dataEvent(I{i});
+  };
+
+  auto hops = chain<MapHop<I>>(depth);
+  auto hopSink = count(0);
+  auto hopEnd =
+      std::make_shared<Filter<I, slct<1>, decltype(hopSink), slct<1>>>(hopSink);
+  hops.second->next(hopEnd, hops.second);
+  auto tHop = timeIt([&] { pass(hops.first); });
+
+  auto flats = chain<NoOp<I>>(depth);
+  auto flatSink = count(1);
+  auto flatEnd =
+      std::make_shared<Filter<I, slct<1>, decltype(flatSink), slct<1>>>(
+          flatSink);
+  flats.second->next(flatEnd, flats.second);
+  auto tFlat = timeIt([&] { pass(flats.first); });
+  karta.print("depth " + std::to_string(depth) + " map of next: " +
+              mrps(tHop) + ", contiguous next: " + mrps(tFlat));
+
+  // eight Map units that add one to the column.
+  auto inc = [](int i) { return i + 1; };
+  using M = Map<meta::MapTypes<I, slct<1>, decltype(inc), slct<2>>>;
+  auto maps = std::make_shared<M>(inc);
+  std::shared_ptr<M> mapLast = maps;
+  for (auto i = 1; i < 8; ++i) {
+    auto cur = std::make_shared<M>(inc);
+    mapLast->next(cur, mapLast);
+    mapLast = cur;
+  }
+  auto mapSink = count(2);
+  auto mapEnd =
+      std::make_shared<Filter<I, slct<1>, decltype(mapSink), slct<1>>>(mapSink);
+  mapLast->next(mapEnd, mapLast);
+  auto tMap = timeIt([&] { pass(maps); });
+
+  // the same in map expressions of a dataflow, fused in a single unit.
+  auto src = std::make_shared<NoOp<I>>();
+  auto fl = ezl::flow(src)
+                .map(inc).colsResult().map(inc).colsResult()
+                .map(inc).colsResult().map(inc).colsResult()
+                .map(inc).colsResult().map(inc).colsResult()
+                .map(inc).colsResult().map(inc).colsResult()
+                .build();
+  auto fusedSink = count(3);
+  auto fusedEnd =
+      std::make_shared<Filter<I, slct<1>, decltype(fusedSink), slct<1>>>(
+          fusedSink);
+  fl->next(fusedEnd, fl);
+  auto tFused = timeIt([&] { pass(src); });
+  karta.print("8 Map units: " + mrps(tMap) + ", 8 fused map expressions: " +
+              mrps(tFused));
+  if (sum[0] != sum[1] || sum[2] != sum[3] ||
+      sum[2] - sum[0] != 8LL * (long long)nRows) {
+    throw std::runtime_error("row sum mismatch.");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ezl::Env env{argc, argv, false};
+  try {
+    linkChainBench(argc, argv);
+  } catch (const std::exception& ex) {
+    std::cerr<<"error: "<<ex.what()<<'\n';
+    env.abort(1);
+  } catch (...) {
+    std::cerr<<"unknown exception\n";
+    env.abort(2);
+  }
+  return 0;
+}
+
+/*!
+ * benchmark results: Linux(single core); rows: 2M; units: M rows/s
+ *  *depth*  | map of next | contiguous next |
+ *  ---      |---          |---              |
+ *  *4*      | 39.7        | 117.9           |
+ *  *16*     | 9.4         | 36.1            |
+ *  *64*     | 0.8         | 7.2             |
+ *
+ *  8 `Map` units linked one after another pass 32 M rows/s, the 8 map
+ *  expressions of a dataflow that are fused in a single unit pass 113 M
+ *  rows/s.
+ *
+ * The rows are passed with a virtual call for each unit either way. The
+ * map of next units adds a walk over its tree nodes for every row that gets
+ * costlier as the nodes of the deeper chains fall out of the cache.
+ */
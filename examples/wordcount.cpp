@@ -25,7 +25,9 @@ void wordcount(int argc, char* argv[]) {
     return;
   }
   const std::string outFile = "data/output/wc.txt";
-  ezl::rise(ezl::fromFile<string>(argv[1]).rowSeparator('s').colSeparator(""))
+  // prefetch reads the next blocks in background while the words are counted
+  ezl::rise(ezl::fromFile<string>(argv[1]).rowSeparator('s').colSeparator("")
+                                          .prefetch())
     .reduce<1>(ezl::count(), 0).inprocess()
     .reduce<1>(ezl::sum(), 0).dump(outFile)
     .run();
@@ -0,0 +1,227 @@
+/*!
+ * @file
+ * class FromBinary, unit for loading data from binary columnar files.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+
+#ifndef FROMBINARY_EZL_H
+#define FROMBINARY_EZL_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <tuple>
+#include <vector>
+
+#include <ezl/helper/BinaryColumns.hpp>
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/MappedRange.hpp>
+#include <ezl/helper/rootShare.hpp>
+#include <ezl/helper/vglob.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup algorithms
+ * function object for loading the rows dumped with `dumpBinary`, to be used
+ * with rise. The files are memory mapped and the columns are copied to the
+ * row without any parsing.
+ *
+ * The blocks of the files are divided between the processes by their size,
+ * a block belongs to the process in whose share of the total bytes it
+ * begins. A file with different columns than the row type is skipped with a
+ * warning.
+ *
+ * Example usage:
+ * @code
+ * rise(fromFile<int, float>("*.txt")).dumpBinary("data.ezb").run();
+ * rise(fromBinary<int, float>("data*.ezb")).reduce<1>(...).run();
+ * @endcode
+ * */
+template <class I>
+class FromBinary {
+public:
+  using Columns = BinaryColumns<I>;
+
+  FromBinary(std::string fpat) : _fpat{fpat} {}
+
+  FromBinary(std::vector<std::string> fnames) : _flist{fnames} {}
+
+  /*!
+   * whether to split the blocks among available processes.
+   * */
+  auto split(bool isSplit = true) && {
+    _isSplit = isSplit;
+    return std::move(*this);
+  }
+  /*!
+   * whether to split the blocks among available processes.
+   * */
+  auto& split(bool isSplit = true) & {
+    _isSplit = isSplit;
+    return *this;
+  }
+  auto limitFiles(size_t count) && {
+    _limitFiles = count;
+    return std::move(*this);
+  }
+  auto& limitFiles(size_t count) & {
+    _limitFiles = count;
+    return *this;
+  }
+  /*!
+   * called by rise to pass process information before running of the dataflow
+   * */
+  void operator () (const int& pos, const std::vector<int>& procs) {
+    std::vector<std::string> fnames;
+    std::vector<long long> sizes;
+    std::tie(fnames, sizes) = rootShare(pos, procs, [this] {
+      auto names = _fpat.empty() ? _flist : vglob(_fpat, _limitFiles);
+      std::vector<long long> lens;
+      for (const auto& it : names) {
+        struct stat st;
+        lens.push_back((::stat(it.c_str(), &st) == 0) ? st.st_size : 0);
+      }
+      return std::make_pair(names, lens);
+    });
+    if (!_fpat.empty() && fnames.empty()) {
+      Karta::inst().log("No file found for pattern: " + _fpat,
+                        LogMode::warning);
+    }
+    auto total = 0LL;
+    for (auto it : sizes) total += it;
+    auto begin = 0LL;
+    auto end = total;
+    if (_isSplit && !procs.empty()) {
+      auto share = total / (long long)procs.size();
+      begin = share * pos;
+      if (pos != int(procs.size()) - 1) end = share * (pos + 1);
+    }
+    _shares.clear();
+    auto preSize = 0LL;
+    for (size_t i = 0; i < fnames.size(); ++i) {
+      auto first = std::max(begin - preSize, 0LL);
+      auto last = std::min(end - preSize, sizes[i]);
+      if (first < last) _shares.push_back(Share{fnames[i], first, last});
+      preSize += sizes[i];
+    }
+    _cur = 0;
+    _rowsLeft = 0;
+    _mf.reset();
+  }
+  /*!
+   * called by rise for pulling data.
+   * */
+  auto operator () () {
+    _more = true;
+    while (!_rowsLeft) {
+      if (!_nextBlock()) {
+        _more = false;
+        return std::tie(_out, _more);
+      }
+    }
+    --_rowsLeft;
+    _cols.get(_out);
+    return std::tie(_out, _more);
+  }
+
+private:
+  // blocks that begin in [begin, end) of the file are read.
+  struct Share {
+    std::string fname;
+    long long begin;
+    long long end;
+  };
+
+  bool _nextBlock() {
+    while (_cur < _shares.size()) {
+      if (!_mf && !_openFile()) {
+        ++_cur;
+        continue;
+      }
+      const auto& sh = _shares[_cur];
+      while (_it != _mf->end() && _it - _mf->begin() < sh.end) {
+        uint32_t nRows;
+        auto next = Columns::blockEnd(_it, _mf->end(), nRows);
+        auto isMine = next && _it - _mf->begin() >= sh.begin && nRows;
+        if (!next || (isMine && !_cols.read(_it, next))) {
+          Karta::inst().log("Incomplete block in file " + sh.fname,
+                            LogMode::warning);
+          break;
+        }
+        _it = next;
+        if (isMine) {
+          _rowsLeft = nRows;
+          return true;
+        }
+      }
+      _mf.reset();
+      ++_cur;
+    }
+    return false;
+  }
+
+  bool _openFile() {
+    const auto& fname = _shares[_cur].fname;
+    _mf = std::make_unique<MappedRange>();
+    if (!_mf->open(fname)) {
+      Karta::inst().log("can not open file: " + fname, LogMode::warning);
+      _mf.reset();
+      return false;
+    }
+    if (!Columns::isHeader(_mf->begin(), _mf->end())) {
+      Karta::inst().log("columns in file " + fname +
+                        " are different from the row type", LogMode::warning);
+      _mf.reset();
+      return false;
+    }
+    _it = _mf->begin() + Columns::headerSize;
+    return true;
+  }
+
+  std::string _fpat;
+  std::vector<std::string> _flist;
+  bool _isSplit{true};
+  size_t _limitFiles{0};
+  std::vector<Share> _shares;
+  size_t _cur{0};
+  std::unique_ptr<MappedRange> _mf;
+  const char* _it{nullptr};
+  Columns _cols;
+  size_t _rowsLeft{0};
+  I _out;
+  bool _more{true};
+};
+} // namespace detail
+
+/*!
+ * ctor function for FromBinary with a glob pattern for the files.
+ * */
+template <class... Is>
+auto fromBinary(std::string fpat) {
+  static_assert(detail::BinaryRow<std::tuple<Is...>>::supported,
+                "binary columns need to be trivially copyable or string.");
+  return detail::FromBinary<std::tuple<Is...>>{fpat};
+}
+
+/*!
+ * ctor function for FromBinary with a list of the files.
+ * */
+template <class... Is>
+auto fromBinary(std::vector<std::string> fnames) {
+  static_assert(detail::BinaryRow<std::tuple<Is...>>::supported,
+                "binary columns need to be trivially copyable or string.");
+  return detail::FromBinary<std::tuple<Is...>>{fnames};
+}
+
+} // namespace ezl
+
+#endif // !FROMBINARY_EZL_H
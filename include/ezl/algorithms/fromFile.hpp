@@ -13,20 +13,38 @@
 #ifndef FROMFILE_EZL_H
 #define FROMFILE_EZL_H
 
+#include <cstdio>
 #include <fstream>
 #include <functional>
 #include <ios>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <set>
+#include <sstream>
+#include <sys/stat.h>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/range/iterator_range.hpp>
 
+#include <ezl/algorithms/fromBinary.hpp>
+#include <ezl/helper/BatchQueue.hpp>
+#include <ezl/helper/BinaryColumns.hpp>
+#include <ezl/helper/ChunkQueue.hpp>
+#include <ezl/helper/DelimSet.hpp>
+#ifdef EZL_ZLIB
+#include <ezl/helper/GzStreamBuf.hpp>
+#endif
+#include <ezl/helper/MappedRange.hpp>
+#include <ezl/helper/RowRange.hpp>
 #include <ezl/helper/meta/lexCastTuple.hpp>
 #include <ezl/helper/meta/slctTuple.hpp>
+#include <ezl/helper/rootShare.hpp>
+#include <ezl/helper/sizeShare.hpp>
 #include <ezl/helper/vglob.hpp>
 #include <ezl/helper/Karta.hpp>
 
@@ -107,24 +125,8 @@ private:
 
 namespace detail {
 
-template <class C>
-inline void stripContainer(const C &inp, C &out, const std::vector<int> &mask) {
-  int len = mask.size();
-  for (int i = 0; i < len; i++) {
-    if (mask[i] > 0 && mask[i] <= int(inp.size())) {
-      out.push_back(inp[mask[i] - 1]);
-    }
-  }
-}
-
-template <class C>
-inline void stripContainerBool(const C &in, C &out,
-                               const std::vector<int> &mask) {
-  int len = mask.size();
-  for (int i = 0; i < len; i++) {
-    if (mask[i] != 0) { out.push_back(in[i]); }
-  }
-}
+// a column of a row as a view in the memory mapped file.
+using CharRange = boost::iterator_range<const char*>;
 } // namespace ezl::detail
 
 
@@ -144,12 +146,27 @@ struct FromFileProps {
   size_t rowsMax{0};
   std::string fpat = "";
   size_t filesMax{0};
+  bool mmap{false};
+  size_t threads{1};
+  bool keepOrder{true};
+  size_t prefetchBytes{0};
+  size_t prefetchDepth{2};
+  std::string cacheDir;
+  bool dynamic{false};
+  size_t chunkBytes{0};
 };
 
 /*!
  * @ingroup units
  * Root unit for loading data from file(s) in parallel with lots of options.
  *
+ * If built with zlib (`-DEZL_ZLIB`, default with cmake if found) the gzip
+ * compressed files are detected from the magic bytes and decompressed while
+ * streaming. The blocked gzip files (BGZF, e.g. from `bgzip`) are shared
+ * between the processes by blocks in the same way as the plain files by
+ * bytes. If there is a gzip file without blocks the files are read whole by
+ * the processes as with tillEOF. The compressed files are not memory mapped,
+ * prefetched or parsed on threads.
  * */
 template <class I, class Kslct>
 class FromFile {
@@ -176,7 +193,8 @@ public:
                  is performed to make it of same size as expected.
  * @param tillEOF parallel reading on per file basis rather than total size.
                 processes start to read from beginning of file and read till
-                end.
+                end. The files are given to the processes such that each
+                has about the same bytes to read.
  * @param addFileName addFileName to every row or not.
  * @param share Does processes have same glob pattern/files that are to be
                 shared among them.
@@ -277,18 +295,203 @@ public:
     _props.rowsMax = nRows;
     return std::move(*this);
   }
+
+  /*!
+   * read the files by memory mapping the share of the process instead of
+   * streaming. Columns are tokenized as views in the mapped memory and only
+   * the typed row is materialized.
+   * */
+  auto memoryMap(bool isMmap = true) {
+    _props.mmap = isMmap;
+    return std::move(*this);
+  }
   
+  /*!
+   * parse the share of the process on `n` threads. The share is split into
+   * chunks that begin and end at rows in the same way as the shares of the
+   * processes, the chunks are read memory mapped and the batches parsed by
+   * the threads are given to the next units whole. If `keepOrder` is false
+   * the batches are given as soon as ready rather than in the file order.
+   * Not used with a parse check (e.g. lammps) or ordered keys, which need
+   * the rows in sequence.
+   * */
+  auto threads(size_t n, bool keepOrder = true) {
+    _props.threads = n;
+    _props.keepOrder = keepOrder;
+    return std::move(*this);
+  }
+
+  /*!
+   * read the files on a background thread in blocks of `bufferBytes`, with
+   * upto `depth` blocks of a file read ahead of the rows being parsed. The
+   * next file is opened and read while the current one is parsed. Useful
+   * on network file systems where reading stalls the parsing. Not used with
+   * memoryMap or threads, which read ahead on their own.
+   * */
+  auto prefetch(size_t bufferBytes = 1 << 20, size_t depth = 2) {
+    _props.prefetchBytes = bufferBytes;
+    _props.prefetchDepth = depth;
+    return std::move(*this);
+  }
+
+  /*!
+   * keep the rows read by the process in a binary file in directory `dir`
+   * and read them from it in the later runs if the files with their sizes
+   * and modified times, the row type, the options including the read mode
+   * and the number of processes and position of the process are the same.
+   * A parse check is told apart by its type, e.g. two lambdas are different
+   * but the state captured by a lambda is assumed to be unchanged.
+   * */
+  auto cache(std::string dir) {
+    _props.cacheDir = dir;
+    return std::move(*this);
+  }
+
+  /*!
+   * divide the bytes of the files in chunks of `chunkBytes` that the
+   * processes take as they get done with the prior, rather than a fixed
+   * share each, for nodes or rows that take varying time. With tillEOF a
+   * chunk is a file, larger files first. If `chunkBytes` is zero there are
+   * `ChunkQueue::chunksPerProc` chunks for each process. The rows of the
+   * chunks of a process are not in file order. Threads, prefetch and cache
+   * are not used with it.
+   * */
+  auto dynamic(size_t chunkBytes = 0) {
+    _props.dynamic = true;
+    _props.chunkBytes = chunkBytes;
+    return std::move(*this);
+  }
+
   auto lammps() {
     return parse(lammpsSchema());
   }
 
+  /*!
+   * called by rise for pulling data, gives the next batch of rows. The
+   * batches parsed by the threads are given as they are, else upto
+   * `batchRows` rows are read in a batch.
+   * */
   inline auto operator() () {
+    if (_fromCache) {
+      _fillBatch(*_fromCache);
+    } else if (_threaded) {
+      _nextParsed();
+    } else {
+      _fillBatch([this] { return _next(); });
+    }
+    if (_cacheOs) {
+      for (const auto& it : _batch) {
+        _cacheCols.add(it);
+        if (_cacheCols.bytes() >= cacheBlockBytes) _cacheCols.write(*_cacheOs);
+      }
+      if (_batch.empty()) _closeCache();
+    }
+    return detail::makeRowRange(_batch.cbegin(), _batch.cend());
+  }
+
+  // number of rows in a batch if not parsed by the threads.
+  static constexpr size_t batchRows = 1024;
+
+  /*!
+   * Divide all the files data equally between the task processes.
+   * */
+  void operator() (int pos, std::vector<int> procs) {
+    _pipe.reset();
+    _reader.reset();
+    _fromCache.reset();
+    _cacheOs.reset();
+    _threaded = false;
+    _isEnd = false;
+    _isDynamic = false;
+    _mapped = false;
+    in = preBreak = prepreBreak = false;
+    first = true;
+    _rowsRead = 0;
+    _colDelims.reset(_props.cDelims);
+    _rowDelims.reset(_props.rDelim == 's' ? std::string{" \t\n\r"}
+                                          : std::string(1, _props.rDelim));
+    _stats = detail::rootShare(pos, procs, [this] { return _statFiles(); });
+    _props.fnames = _stats.fnames;
+    if(!_props.headers.empty()) _headerCols(_props.cols, _props.headers);
+    if(!_props.dropHead.empty()) _headerCols(_props.drop, _props.dropHead);
+    _sanityCheck();
+    _compilePlan();
+    if(!_props.fpat.empty() && _props.fnames.empty()) {
+      Karta::inst().log("No file found for pattern: "+_props.fpat, LogMode::warning);
+      return;
+    }
+    _pos = pos;
+    if (pos == -1 || _props.fnames.empty()) return;
+    _tillEOF = _props.tilleof || !_props.share || _hasUnblocked();
+    if (_props.dynamic && _props.share) {
+      _startDynamic(pos, procs);
+      return;
+    }
+    if (!_props.cacheDir.empty() && _openCache(pos, procs)) return;
+    _shareFiles(pos, procs.size());
+    if (_rBeginFile == -1) return;
+    if (_props.threads > 1) {
+      _startThreads();
+    } else if (_props.prefetchBytes && !_props.mmap) {
+      _startReader();
+    }
+  }
+
+private:
+  // the file list and the details from the file system that are read by the
+  // first process of the unit and sent to the rest.
+  struct FileStats {
+    std::vector<std::string> fnames;
+    std::vector<long long> sizes;  // -1 if the file can not be stat
+    std::vector<long long> mtimes;
+    std::string head;  // first row of the first file if headers are selected
+    long long unblocked{-1};  // a gzip file without blocks
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+      ar & fnames & sizes & mtimes & head & unblocked;
+    }
+  };
+
+  FileStats _statFiles() {
+    FileStats st;
+    st.fnames = _props.fpat.empty()
+                    ? _props.fnames
+                    : detail::vglob(_props.fpat, _props.filesMax);
+    for (const auto& it : st.fnames) {
+      struct stat fst;
+      auto isStat = (::stat(it.c_str(), &fst) == 0);
+      st.sizes.push_back(isStat ? fst.st_size : -1);
+      st.mtimes.push_back(isStat ? fst.st_mtime : -1);
+#ifdef EZL_ZLIB
+      if (_props.share && !_props.tilleof && st.unblocked == -1 &&
+          detail::GzStreamBuf::detect(it) == detail::GzStreamBuf::Format::gzip) {
+        st.unblocked = st.sizes.size() - 1;
+      }
+#endif
+    }
+    auto isHead = !_props.headers.empty() || !_props.dropHead.empty();
+    if (isHead && !st.fnames.empty()) {
+      auto buf = _openBuf(st.fnames[0]);
+      if (buf) {
+        std::istream f(buf);
+        std::getline(f, st.head, _props.rDelim);
+      }
+    }
+    return st;
+  }
+
+  inline auto _next() {
     rs cur;
     while (true) {
       if (!loaded) {
-        if (!_nextFile()) break;
-        else loaded = true;
+        if (!_nextFile()) {
+          if (_isDynamic && _nextChunk()) continue;
+          break;
+        }
+        loaded = true;
+        _fileBegin = true;
       }
+      if (_isDynamic) _queue.poll();
       std::tie(cur, accept) = _lineHai();
       if (cur == rs::eof) {
         loaded = false;
@@ -302,47 +505,143 @@ public:
     return std::tie(_out, loaded);
   }
 
-  /*!
-   * Divide all the files data equally between the task processes.
-   * */
-  void operator() (int pos, std::vector<int> procs) {
+  // a part of a file to be parsed by a thread.
+  struct Chunk {
+    long long file;
+    long long begin;
+    long long end;
+    bool skip;  // the first partial row
+  };
+
+  static constexpr size_t cacheBlockBytes = 1 << 20;
+
+  // the bytes of the files, or the files whole, are divided in chunks that
+  // the processes take on demand. Nothing is read till the first chunk.
+  void _startDynamic(int pos, const std::vector<int>& procs) {
+    if (_props.threads > 1 || _props.prefetchBytes || !_props.cacheDir.empty()) {
+      Karta::inst().log("fromFile threads, prefetch and cache are not used "
+                        "with dynamic.", LogMode::warning);
+    }
+    _isDynamic = true;
+    _allFiles = _props.fnames;
+    _allSizes = _stats.sizes;
+    if (_tillEOF) {
+      _queue.reset(pos, procs, _allFiles.size(), 1);
+    } else {
+      auto total = 0LL;
+      for (auto it : _allSizes) total += std::max(it, 0LL);
+      _queue.reset(pos, procs, total, _props.chunkBytes);
+    }
+    _rBeginFile = -1;
+  }
+
+  // a chunk is read in the same way as the share of a process at position of
+  // the chunk for as many processes as the chunks, i.e. a file if whole. The
+  // file list is cleared on reaching the limit of rows or end of data.
+  bool _nextChunk() {
+    size_t chunk;
+    if (_props.fnames.empty() || !_queue.next(chunk)) {
+      _queue.finish();
+      return false;
+    }
+    _props.fnames = _allFiles;
+    _stats.sizes = _allSizes;
+    _shareFiles(chunk, _queue.count());
+    _pos = chunk;
+    _cur = -1;
     in = preBreak = prepreBreak = false;
     first = true;
-    _rowsRead = 0;
-    if(!_props.headers.empty()) _headerCols(_props.cols, _props.headers);
-    if(!_props.dropHead.empty()) _headerCols(_props.drop, _props.dropHead);
-    _sanityCheck();
-    if(!_props.fpat.empty()) {
-      _props.fnames.clear();
-      _props.fnames = detail::vglob(_props.fpat, _props.filesMax);
-      if(_props.fnames.empty()) {
-        Karta::inst().log("No file found for pattern: "+_props.fpat, LogMode::warning);
-        return;
+    return true;
+  }
+
+  // the cache of the process is named by the hash of its key, the key is
+  // kept along to check it. The key is written after the rows, hence a
+  // cache with key is complete.
+  bool _openCache(int pos, const std::vector<int>& procs) {
+    if (!detail::BinaryRow<I>::supported) {
+      Karta::inst().log("fromFile cache needs columns that are trivially "
+                        "copyable or string.", LogMode::warning);
+      return false;
+    }
+    std::ostringstream key;
+    key << typeid(I).name() << ' ' << typeid(Kslct).name() << ' ' << pos
+        << '/' << procs.size() << ' ' << int(_props.rDelim) << ' '
+        << _props.cDelims << ' ' << _props.strict << _props.tilleof
+        << _props.addFileName << _props.share << _props.mmap
+        << _props.keepOrder << bool(_props.prefetchBytes) << _props.dynamic
+        << ' ' << _props.threads << ' ' << _props.rowsMax << ' '
+        << _props.check.target_type().name() << '\n';
+    for (auto it : _props.cols) key << it << ' ';
+    key << '\n';
+    for (auto it : _props.drop) key << it << ' ';
+    key << '\n';
+    for (size_t i = 0; i < _props.fnames.size(); ++i) {
+      key << _props.fnames[i] << ' ' << _stats.sizes[i] << ' '
+          << _stats.mtimes[i] << '\n';
+    }
+    std::ostringstream name;
+    name << _props.cacheDir << "/fromFile_" << std::hex
+         << std::hash<std::string>{}(key.str()) << ".ezb";
+    _cachePath = name.str();
+    _cacheKey = key.str();
+    std::ifstream keyFile(_cachePath + ".key", std::ios::binary);
+    if (keyFile.is_open()) {
+      std::ostringstream saved;
+      saved << keyFile.rdbuf();
+      if (saved.str() == _cacheKey) {
+        _fromCache = std::make_unique<detail::FromBinary<I>>(
+            std::vector<std::string>{_cachePath});
+        (*_fromCache)(0, std::vector<int>{0});
+        return true;
       }
     }
-    _pos = pos;
-    if (pos == -1 || _props.fnames.empty()) return;
+    ::mkdir(_props.cacheDir.c_str(), 0755);
+    _cacheOs = std::make_unique<std::ofstream>(
+        _cachePath + ".tmp", std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!_cacheOs->is_open()) {
+      Karta::inst().log("can not write cache: " + _cachePath, LogMode::warning);
+      _cacheOs.reset();
+      return false;
+    }
+    *_cacheOs << detail::BinaryColumns<I>::header();
+    return false;
+  }
+
+  void _closeCache() {
+    _cacheCols.write(*_cacheOs);
+    _cacheOs->close();
+    auto isDone = !_cacheOs->fail() &&
+        std::rename((_cachePath + ".tmp").c_str(), _cachePath.c_str()) == 0;
+    if (isDone) {
+      std::ofstream keyFile(_cachePath + ".key", std::ios::binary);
+      keyFile << _cacheKey;
+      isDone = bool(keyFile);
+    }
+    if (!isDone) {
+      Karta::inst().log("can not write cache: " + _cachePath, LogMode::warning);
+    }
+    _cacheOs.reset();
+  }
+
+  void _shareFiles(int pos, int nProc) {
     if (!_props.share) {
-      _props.tilleof = true;
       _rBeginFile = 0;
       _rEndFile = _props.fnames.size() - 1;  // not return
       return;
     }
-    if (_props.tilleof) {
-      _divideFiles(pos, procs);
+    if (_tillEOF) {
+      _divideFiles(pos, nProc);
       return;
     }
     auto total = 0LL;
     std::vector<long long> cumSizes;
     cumSizes.reserve(_props.fnames.size() + 1);
-    for (auto &it : _props.fnames) {
-      std::ifstream in(it, std::ifstream::ate | std::ifstream::binary);
-      long long len = in.tellg();
+    for (auto len : _stats.sizes) {
       cumSizes.push_back(total);
-      total += len;
+      total += std::max(len, 0LL);
     }
     cumSizes.push_back(total);
-    long long share = total / procs.size(); // TODO LL cast
+    long long share = total / nProc;
     _rBeginFile = -1;
     _rBeginByte = 0;
     auto rTotalBeginByte = share * pos;
@@ -353,7 +652,7 @@ public:
     auto preSize = 0LL;
     preSize = cumSizes[_rBeginFile];
     _rBeginByte = rTotalBeginByte - preSize;
-    if (pos == int(procs.size()) - 1) {
+    if (pos == nProc - 1) {
       _rEndFile = _props.fnames.size() - 1;
       _rEndByte = cumSizes[cumSizes.size() - 1];
       if (_rEndFile > 0) { _rEndByte -= cumSizes[cumSizes.size() - 2]; }
@@ -374,41 +673,194 @@ public:
     //std::cout<<this->par().rank()<<std::endl;
     //std::cout<<"begin at: "<<_rBeginFile<<std::endl;
     //std::cout<<"end at: "<<_rEndFile<<std::endl;
-    _rEndFile -= _rBeginFile;
-    for (int i = 0; i <= _rEndFile; i++) {
-      _props.fnames[i] = _props.fnames[i + _rBeginFile];
+    std::vector<size_t> files(_rEndFile - _rBeginFile + 1);
+    std::iota(std::begin(files), std::end(files), size_t(_rBeginFile));
+    _keepFiles(files);
+  }
+
+  // removes the files other than the share of the process, given in the
+  // order of the list, from the list.
+  void _keepFiles(const std::vector<size_t>& files) {
+    for (size_t i = 0; i < files.size(); i++) {
+      _props.fnames[i] = _props.fnames[files[i]];
+      _stats.sizes[i] = _stats.sizes[files[i]];
     }
     _rBeginFile = 0;
-    _props.fnames.resize(_rEndFile + 1);
+    _rEndFile = files.size() - 1;
+    _props.fnames.resize(files.size());
+    _stats.sizes.resize(files.size());
   }
 
-private:
+  // chunks of about a quarter of share per thread. The rows that begin in
+  // (begin, end] of a chunk are its own, or [begin, end] if it is at the
+  // beginning of the share of the first process or of a file.
+  void _startThreads() {
+    if (_props.check || ksize) {
+      Karta::inst().log("fromFile threads are not used with a parse check "
+                        "or ordered keys.", LogMode::warning);
+      return;
+    }
+    if (_hasCompressed()) {
+      Karta::inst().log("fromFile threads are not used with compressed files.",
+                        LogMode::warning);
+      return;
+    }
+    std::vector<Chunk> ranges;
+    auto total = 0LL;
+    for (auto i = _rBeginFile; i <= _rEndFile; ++i) {
+      auto size = std::max(_stats.sizes[i], 0LL);
+      auto isShared = !_tillEOF;
+      auto begin = (isShared && i == _rBeginFile) ? _rBeginByte : 0LL;
+      auto end = (isShared && i == _rEndFile) ? _rEndByte : (long long)size;
+      ranges.push_back(Chunk{i, begin, end,
+                             isShared && i == _rBeginFile && _pos != 0});
+      total += end - begin;
+    }
+    const auto piece = std::max(total / (long long)(_props.threads * 4), 1LL);
+    std::vector<Chunk> chunks;
+    for (const auto& it : ranges) {
+      auto begin = it.begin;
+      while (true) {
+        auto end = std::min(begin + piece, it.end);
+        chunks.push_back(Chunk{it.file, begin, end,
+                               begin == it.begin ? it.skip : true});
+        if (end >= it.end) break;
+        begin = end;
+      }
+    }
+    _threaded = true;
+    _pipe = std::make_unique<detail::BatchQueue<I>>();
+    _pipe->start(chunks.size(), _props.threads, _props.keepOrder, 4,
+        [this, chunks](size_t i, auto& push) { _parseChunk(chunks[i], push); });
+  }
+
+  // runs on a worker thread, only reads the members.
+  template <class Push>
+  void _parseChunk(const Chunk& chunk, Push& push) const {
+    detail::MappedRange mf;
+    if (!mf.open(_props.fnames[chunk.file], chunk.begin)) return;
+    auto it = mf.begin();
+    const auto last = mf.end();
+    if (chunk.skip) {
+      it = _rowDelims.find(it, last);
+      if (it != last) ++it;
+    }
+    std::vector<detail::CharRange> tokens, slct;
+    I row;
+    std::vector<I> batch;
+    batch.reserve(batchRows);
+    const char *rowBegin, *rowEnd;
+    while (true) {
+      auto next = _viewRow(it, last, rowBegin, rowEnd);
+      if (!next || chunk.begin + (rowBegin - mf.begin()) > chunk.end) break;
+      if (_parseRow(rowBegin, rowEnd, chunk.file, tokens, slct, row)) {
+        batch.push_back(row);
+        if (batch.size() == batchRows) {
+          if (!push(std::move(batch))) return;
+          batch.clear();
+          batch.reserve(batchRows);
+        }
+      }
+      it = next;
+    }
+    if (!batch.empty()) push(std::move(batch));
+  }
+
+  bool _parseRow(const char* first, const char* last, long long file,
+                 std::vector<detail::CharRange>& tokens,
+                 std::vector<detail::CharRange>& slct, I& out) const {
+    if (!_props.addFileName) return _projectRow(first, last, slct, out);
+    _splitView(first, last, tokens);
+    const auto& name = _props.fnames[file];
+    tokens.emplace_back(name.data(), name.data() + name.size());
+    return _castRow(tokens, slct, out);
+  }
+
+  // a thread reads the files in the share in blocks, an empty block marks
+  // the end of a file. The reader has its own copy of the names since the
+  // list is cleared on reaching the end of data.
+  void _startReader() {
+    if (_hasCompressed()) {
+      Karta::inst().log("fromFile prefetch is not used with compressed files.",
+                        LogMode::warning);
+      return;
+    }
+    std::vector<std::string> names(_props.fnames.begin() + _rBeginFile,
+                                   _props.fnames.begin() + _rEndFile + 1);
+    auto firstByte = _tillEOF ? 0LL : _rBeginByte;
+    auto bytes = _props.prefetchBytes;
+    _unreadable = std::make_shared<std::vector<char>>(names.size(), 0);
+    auto unreadable = _unreadable;
+    _fileDone = true;
+    _reader = std::make_unique<detail::BatchQueue<char>>();
+    _reader->start(names.size(), 1, true, _props.prefetchDepth,
+        [names, firstByte, bytes, unreadable](size_t i, auto& push) {
+          std::filebuf fb;
+          if (!fb.open(names[i], std::ios::in | std::ios::binary)) {
+            (*unreadable)[i] = 1;
+          } else {
+            if (i == 0 && firstByte) fb.pubseekpos(firstByte);
+            while (true) {
+              std::vector<char> block(bytes);
+              auto n = fb.sgetn(block.data(), block.size());
+              if (n <= 0) break;
+              block.resize(n);
+              if (!push(std::move(block))) return;
+            }
+          }
+          push(std::vector<char>{});
+        });
+  }
+
+  // next batch of rows from a source that gives a row with a flag at a time,
+  // the source is not called again after its end.
+  template <class F>
+  void _fillBatch(F&& next) {
+    _batch.clear();
+    while (!_isEnd && _batch.size() < batchRows) {
+      auto res = next();
+      if (!std::get<1>(res)) {
+        _isEnd = true;
+        break;
+      }
+      _batch.emplace_back(std::move(std::get<0>(res)));
+    }
+  }
+
+  // next batch parsed by the threads, cut at the limit of rows.
+  void _nextParsed() {
+    _batch.clear();
+    auto isLimit = _props.rowsMax && _rowsRead >= _props.rowsMax;
+    while (_batch.empty()) {
+      if (isLimit || !_pipe || !_pipe->pop(_batch)) {
+        _pipe.reset();
+        _batch.clear();
+        return;
+      }
+    }
+    if (_props.rowsMax) {
+      auto n = std::min(_batch.size(), _props.rowsMax - _rowsRead);
+      _batch.erase(_batch.begin() + n, _batch.end());
+      _rowsRead += n;
+    }
+  }
 
   void _headerCols(std::vector<int>& cols, const std::vector<std::string>& headers) {
+    // the first row is read along with the file list by `_statFiles`
     std::string fname; 
     if (!_props.fnames.empty()) {
       fname = _props.fnames[0]; 
-    } else {
-      auto fnames = detail::vglob(_props.fpat, 1);
-      if (!fnames.empty()) fname = fnames[0];
-    }
-    if (!fname.empty()) {
-      std::ifstream f(fname);
-      if(f.is_open()) {
-        std::string line;
-        std::getline(f, line, _props.rDelim);
-        std::vector<std::string> vstr;
-        if (_props.cDelims != "none") {
-          boost::split(vstr, line, boost::is_any_of(_props.cDelims),
-                       boost::token_compress_on);
-        } else {
-          vstr.push_back(line);
-        }
-        for(const auto& head : headers) {
-          auto it = std::find(std::begin(vstr), std::end(vstr), head);
-          if (it == std::end(vstr)) break;
-          else cols.push_back(it - std::begin(vstr) + 1);
-        }
+      std::vector<std::string> vstr;
+      if (_props.cDelims != "none") {
+        boost::split(vstr, _stats.head, boost::is_any_of(_props.cDelims),
+                     boost::token_compress_on);
+      } else {
+        vstr.push_back(_stats.head);
+      }
+      for(const auto& head : headers) {
+        auto it = std::find(std::begin(vstr), std::end(vstr), head);
+        if (it == std::end(vstr)) break;
+        else cols.push_back(it - std::begin(vstr) + 1);
       }
     }
     if (cols.size() != headers.size()) {
@@ -450,91 +902,139 @@ row types are different.");
     }
   }
 
-  void _divideFiles (int pos, std::vector<int> procs) {
-    auto share = int(_props.fnames.size() / procs.size());
-    if (share == 0) share = 1;
-    _rBeginFile = share * pos;
-    _rEndFile = share * (pos + 1) - 1;
-    if (_rEndFile > int(_props.fnames.size() - 1) || pos == int(procs.size()) - 1) {
-      _rEndFile = _props.fnames.size() - 1;
-    }
-    // removing not required fnames from the list
-    if (_rBeginFile > int(_props.fnames.size() - 1)) {
-      _props.fnames.empty();
+  // whole files are divided between the processes balancing their sizes.
+  void _divideFiles (int pos, int nProc) {
+    auto files = detail::sizeShare(_stats.sizes, pos, nProc);
+    if (files.empty()) {
       _rBeginFile = -1;
     } else {
-      _rEndFile -= _rBeginFile;
-      for (auto i = 0; i <= _rEndFile; i++) {
-        _props.fnames[i] = _props.fnames[i + _rBeginFile];
-      }
-      _rBeginFile = 0;
-      _props.fnames.resize(_rEndFile + 1);
+      _keepFiles(files);
     }
   }
 
-  bool _sizeCheck(std::vector<std::string> &vstr) {
-    if ((_isMask && int(vstr.size()) != _idealSize) ||
-        (!_isMask && int(vstr.size()) < _idealSize)) {
-      if (!_props.strict) {
-        vstr.resize(_idealSize);
-      } else {
-        return false;
+  // compiles cols, dropCols and header selection into the original index of
+  // each of the columns to be cast, once before reading rather than dropping
+  // and selecting from every row.
+  void _compilePlan() {
+    _dropSorted.clear();
+    for (auto it : _props.drop) {
+      if (it > 0) _dropSorted.push_back(it - 1);
+    }
+    std::sort(_dropSorted.begin(), _dropSorted.end());
+    _dropSorted.erase(std::unique(_dropSorted.begin(), _dropSorted.end()),
+                      _dropSorted.end());
+    _slotOrig.clear();
+    if (_props.cols.empty()) {
+      for (auto i = 0; i < _idealSize; ++i) _slotOrig.push_back(_origCol(i));
+    } else if (_isMask) {
+      for (auto i = 0; i < int(_props.cols.size()); ++i) {
+        if (_props.cols[i] != 0) _slotOrig.push_back(_origCol(i));
       }
+    } else {
+      for (auto it : _props.cols) _slotOrig.push_back(_origCol(it - 1));
+    }
+    _lastCol = _idealSize ? _origCol(_idealSize - 1) : -1;
+    _slotOf.assign(_lastCol + 1, -1);
+    for (auto i = 0; i < int(_slotOrig.size()); ++i) {
+      _slotOf[_slotOrig[i]] = i;
+    }
+  }
+
+  // index in the row read of the column at index i after dropping columns.
+  int _origCol(int i) const {
+    for (auto it : _dropSorted) {
+      if (it > i) break;
+      ++i;
+    }
+    return i;
+  }
+
+  // a mask selection or no selection requires the exact number of columns,
+  // an index selection requires at least till the last selected column. If
+  // not strict the row is null padded or spliced to the size.
+  bool _sizeCheck(int nCols) const {
+    auto nDropped = std::lower_bound(_dropSorted.begin(), _dropSorted.end(),
+                                     nCols) - _dropSorted.begin();
+    auto size = nCols - int(nDropped);
+    if ((_isMask && size != _idealSize) || (!_isMask && size < _idealSize)) {
+      return !_props.strict;
     }
     return true;
   }
 
-  std::pair<bool, rs> _processLine(std::string line) {
-    std::vector<std::string> vstr;
-    if (!_props.cDelims.empty()) {
-      boost::split(vstr, line, boost::is_any_of(_props.cDelims),
-                   boost::token_compress_on);
-    } else {
-      vstr.push_back(line);
-    }
-    // delimiters may leave empty strings at the ends
-    if (!vstr.empty() && vstr[vstr.size() - 1].empty()) vstr.pop_back();
-    if (!vstr.empty() && vstr[0].empty()) vstr.erase(std::begin(vstr));
-    if (_props.addFileName) {
-      std::string name = std::string(_props.fnames[_cur]);
-      vstr.push_back(std::move(name));
-    }
-    std::pair<bool, rs> st = std::make_pair(true, rs::br);
-    // pre-check if given
-    if (_props.check) {
-      st = _props.check(vstr); // exception handling or not? check after profiling
-      if (!st.first) { return st; }
-    }
-    if (!_props.drop.empty()) {
-      std::sort(_props.drop.begin(), _props.drop.end(), std::greater<int>());
-      for (auto it : _props.drop) {
-        if (it <= int(vstr.size())) vstr.erase(std::begin(vstr)+it-1);
-      } 
-    }
-    if (!_sizeCheck(vstr)) {
-      st.first = false;
+  // the row is tokenized as views in the line read or in the mapped file,
+  // strings are made only if there is a parse check that needs them.
+  std::pair<bool, rs> _processRow() {
+    auto st = std::make_pair(true, rs::br);
+    if (!_props.check) {
+      st.first = _parseRow(_rowBegin, _rowEnd, _cur, _tokens, _tokensSlct,
+                           _out);
       return st;
     }
-    if (!_props.cols.empty()) {
-      std::vector<std::string> temp;
-      temp.reserve(osize);
-      if (_isMask) {
-        detail::stripContainerBool(vstr, temp, _props.cols);
-      } else {
-        detail::stripContainer(vstr, temp, _props.cols);
+    _splitView(_rowBegin, _rowEnd, _tokens);
+    _vstr.resize(_tokens.size());
+    for (size_t i = 0; i < _tokens.size(); ++i) {
+      _vstr[i].assign(_tokens[i].begin(), _tokens[i].end());
+    }
+    if (_props.addFileName) _vstr.push_back(_props.fnames[_cur]);
+    // exception handling or not? check after profiling
+    st = _props.check(_vstr);
+    if (!st.first) { return st; }
+    st.first = _castRow(_vstr, _vstrSlct, _out);
+    return st;
+  }
+
+  // the views of only the selected columns are kept while tokenizing and
+  // the scan stops at the last selected column unless the size of the row
+  // needs to be checked exactly.
+  bool _projectRow(const char* first, const char* last,
+                   std::vector<detail::CharRange>& slct, I& out) const {
+    slct.assign(_slotOrig.size(), detail::CharRange{});
+    auto nCols = 0;
+    const auto stopAt = _isMask ? -1 : _lastCol;
+    auto keep = [this, &slct, &nCols, stopAt](const char* b, const char* e) {
+      if (nCols <= _lastCol && _slotOf[nCols] != -1) {
+        slct[_slotOf[nCols]] = detail::CharRange{b, e};
       }
-      vstr = std::move(temp);
+      return nCols++ != stopAt;
+    };
+    if (_colDelims.empty()) {
+      if (first != last) keep(first, last);
+    } else {
+      _colDelims.tokens(first, last, keep);
     }
-    try {
-      detail::meta::lexCastTuple(vstr, _out, _props.strict);
-    } catch (boost::bad_lexical_cast) {
-      st.first = false;
-      return st;
-    } catch (...) {
-      st.first = false;
-      return st;
+    return _sizeCheck(nCols) &&
+           detail::meta::lexCastTuple(slct, out, _props.strict);
+  }
+
+  // same as boost::split with token compression and without empty tokens at
+  // the ends.
+  void _splitView(const char* first, const char* last,
+                  std::vector<detail::CharRange>& tokens) const {
+    tokens.clear();
+    if (_colDelims.empty()) {
+      if (first != last) tokens.emplace_back(first, last);
+      return;
     }
-    return st;
+    _colDelims.tokens(first, last, [&tokens](const char* b, const char* e) {
+      tokens.emplace_back(b, e);
+      return true;
+    });
+  }
+
+  // for rows that are given complete to a parse check or have file name.
+  template <class C>
+  bool _castRow(C& vstr, C& slct, I& out) const {
+    if (!_sizeCheck(int(vstr.size()))) return false;
+    slct.resize(_slotOrig.size());
+    for (size_t i = 0; i < _slotOrig.size(); ++i) {
+      if (_slotOrig[i] < int(vstr.size())) {
+        std::swap(slct[i], vstr[_slotOrig[i]]);
+      } else {
+        slct[i] = typename C::value_type{};
+      }
+    }
+    return detail::meta::lexCastTuple(slct, out, _props.strict);
   }
 
   bool _nextFile() {
@@ -542,17 +1042,26 @@ row types are different.");
     _cur++;
     while (_cur < int(_props.fnames.size())) {
       if (_cur >= _rBeginFile && _cur <= _rEndFile) {
-        if (!_fb) _fb = std::make_unique<std::filebuf>();
-        if (_fb->is_open()) _fb->close();
-        _fb->open(_props.fnames[_cur], std::fstream::in); // TODO log error @haptork
-        if (!_fb->is_open()) {
-          Karta::inst().log("can not open file: "+_props.fnames[_cur], LogMode::warning);
+        _mapped = _props.mmap && !_isCompressed(_props.fnames[_cur]);
+        if (_mapped) {
+          if (_openMapped()) return true;
+          _cur++;
+          continue;
+        }
+        if (_reader) {
+          if (_openPrefetched()) return true;
           _cur++;
           continue;
         }
         _is = nullptr;
-        _is = std::make_unique<std::istream>(_fb.get());
-        if (!_props.tilleof && _cur == _rBeginFile) {
+        auto buf = _openBuf(_props.fnames[_cur]);
+        if (!buf) {
+          Karta::inst().log("can not open file: "+_props.fnames[_cur], LogMode::warning);
+          _cur++;
+          continue;
+        }
+        _is = std::make_unique<std::istream>(buf);
+        if (!_tillEOF && _cur == _rBeginFile) {
           (*_is).seekg(_rBeginByte);
           // the seek can start from the middle of a row, hence that row is
           // read in the prior process and ignored in the start of reading.
@@ -571,9 +1080,182 @@ row types are different.");
       }
       _cur++;
     }
+    _reader.reset();
+    return false;
+  }
+
+  // plain files are streamed with filebuf and compressed with GzStreamBuf.
+  std::streambuf* _openBuf(const std::string& fname) {
+#ifdef EZL_ZLIB
+    if (_isCompressed(fname)) {
+      if (!_gz) _gz = std::make_unique<detail::GzStreamBuf>();
+      return _gz->open(fname) ? _gz.get() : nullptr;
+    }
+#endif
+    if (!_fb) _fb = std::make_unique<std::filebuf>();
+    if (_fb->is_open()) _fb->close();
+    _fb->open(fname, std::fstream::in);
+    return _fb->is_open() ? _fb.get() : nullptr;
+  }
+
+  static bool _isCompressed(const std::string& fname) {
+#ifdef EZL_ZLIB
+    return detail::GzStreamBuf::detect(fname) !=
+           detail::GzStreamBuf::Format::plain;
+#else
+    return false;
+#endif
+  }
+
+  bool _hasCompressed() const {
+    for (auto i = _rBeginFile; i <= _rEndFile; ++i) {
+      if (_isCompressed(_props.fnames[i])) return true;
+    }
     return false;
   }
 
+  // a gzip file without blocks can only be read from the beginning, hence
+  // the files are divided whole between the processes.
+  bool _hasUnblocked() const {
+    if (_stats.unblocked == -1) return false;
+    Karta::inst().log("fromFile: " + _props.fnames[_stats.unblocked] +
+                      " is gzip compressed without blocks, the files are "
+                      "read whole by the processes.", LogMode::warning);
+    return true;
+  }
+
+  // the blocks of the file are next in the reader after the rest of the
+  // prior file.
+  bool _openPrefetched() {
+    while (!_fileDone) _nextBlock();
+    auto isShared = !_tillEOF && _cur == _rBeginFile;
+    _blk.clear();
+    _bpos = 0;
+    _blkByte = isShared ? _rBeginByte : 0;
+    _fileDone = false;
+    if (!_nextBlock() && (*_unreadable)[_cur - _rBeginFile]) {
+      Karta::inst().log("can not open file: "+_props.fnames[_cur], LogMode::warning);
+      return false;
+    }
+    // same as in streaming, the partial row at the beginning is read by the
+    // prior process.
+    if (isShared && _pos != 0) {
+      while (_bpos < _blk.size() || _nextBlock()) {
+        const char* first = _blk.data() + _bpos;
+        const char* last = _blk.data() + _blk.size();
+        auto it = _rowDelims.find(first, last);
+        _bpos += (it - first);
+        if (it != last) {
+          ++_bpos;
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool _nextBlock() {
+    if (_fileDone) return false;
+    _blkByte += _blk.size();
+    _bpos = 0;
+    if (!_reader->pop(_blk) || _blk.empty()) {
+      _blk.clear();
+      _fileDone = true;
+      return false;
+    }
+    return true;
+  }
+
+  // sets the view of next row in the blocks, a row split between blocks is
+  // joined in a string. As in streaming, a row without a row separator at
+  // the end of the file is not read.
+  bool _nextBuffered() {
+    _carry.clear();
+    const auto isSpace = (_props.rDelim == 's');
+    while (_bpos < _blk.size() || _nextBlock()) {
+      const char* first = _blk.data() + _bpos;
+      const char* last = _blk.data() + _blk.size();
+      if (isSpace && _carry.empty()) {
+        first = _rowDelims.skip(first, last);
+        _bpos = first - _blk.data();
+        if (first == last) continue;
+      }
+      auto it = _rowDelims.find(first, last);
+      if (it == last) {
+        _carry.append(first, last);
+        _bpos = _blk.size();
+        continue;
+      }
+      if (_carry.empty()) {
+        _rowBegin = first;
+        _rowEnd = it;
+      } else {
+        _carry.append(first, it);
+        _rowBegin = _carry.data();
+        _rowEnd = _carry.data() + _carry.size();
+      }
+      _bpos = (it - _blk.data()) + (isSpace ? 0 : 1);
+      return true;
+    }
+    return false;
+  }
+
+  bool _openMapped() {
+    auto isShared = !_tillEOF && _cur == _rBeginFile;
+    _mbyte = isShared ? _rBeginByte : 0;
+    if (!_mf) _mf = std::make_unique<detail::MappedRange>();
+    if (!_mf->open(_props.fnames[_cur], _mbyte)) {
+      Karta::inst().log("can not open file: "+_props.fnames[_cur], LogMode::warning);
+      return false;
+    }
+    _mcur = _mf->begin();
+    // same as in streaming, the partial row at the beginning is read by the
+    // prior process.
+    if (isShared && _pos != 0) {
+      _mcur = _rowDelims.find(_mcur, _mf->end());
+      if (_mcur != _mf->end()) ++_mcur;
+    }
+    return true;
+  }
+
+  // sets the view of next row in the mapped file.
+  bool _nextView() {
+    auto next = _viewRow(_mcur, _mf->end(), _rowBegin, _rowEnd);
+    if (!next) return false;
+    _mcur = next;
+    return true;
+  }
+
+  // sets the view of the row from `it` in a mapped file that ends at `last`
+  // and gives the position to read the next row from, or nullptr if there
+  // is no row. As in streaming, a row without a row separator at the end of
+  // the file is not read, and a space separator is left after the word.
+  const char* _viewRow(const char* it, const char* last,
+                       const char*& rowBegin, const char*& rowEnd) const {
+    if (_props.rDelim == 's') it = _rowDelims.skip(it, last);
+    auto end = _rowDelims.find(it, last);
+    if (end == last) return nullptr;
+    rowBegin = it;
+    rowEnd = end;
+    return (_props.rDelim == 's') ? end : end + 1;
+  }
+
+  bool _nextRow() {
+    if (_mapped) return _nextView();
+    if (_reader) return _nextBuffered();
+    if (!_nextLine(_line) || (*_is).eof()) return false;
+    _rowBegin = _line.data();
+    _rowEnd = _line.data() + _line.size();
+    return true;
+  }
+
+  // current byte position in the file.
+  long long _tell() {
+    if (_mapped) return _mbyte + (_mcur - _mf->begin());
+    if (_reader) return _blkByte + _bpos;
+    return (*_is).tellg();
+  }
+
   bool _nextLine(std::string &line) {
     if (_props.rDelim == 's') {
       (*_is) >> line; // TODO: check how to modify ret
@@ -585,13 +1267,21 @@ row types are different.");
 
   inline auto _lineHai() {
     using std::make_pair;
-    if (_nextLine(_line) && !(*_is).eof()) {
-      auto status = _processLine(_line);
+    // a share that is within a row has none of its own, the row is read by
+    // the prior process.
+    if (_fileBegin) {
+      _fileBegin = false;
+      if (!_tillEOF && _cur == _rEndFile && _tell() > _rEndByte) {
+        return make_pair(rs::eof, false);
+      }
+    }
+    if (_nextRow()) {
+      auto status = _processRow();
       if (ksize && status.first) {
         curKey = detail::meta::slctTuple(_out, Kslct{});
       }
       auto isOverFlow =
-          (!_props.tilleof && _cur == _rEndFile && (*_is).tellg() > _rEndByte);
+          (!_tillEOF && _cur == _rEndFile && _tell() > _rEndByte);
       if (isOverFlow && ((status.second == rs::prior && preBreak) ||
                          (status.second == rs::ignore) ||
                          (status.second == rs::br && ksize && in &&
@@ -629,6 +1319,7 @@ row types are different.");
 
   bool loaded = false;
   bool accept = false;
+  bool _fileBegin = false;
 
   FromFileProps _props;
 
@@ -642,15 +1333,57 @@ row types are different.");
   I _out;
   long long _cur{-1};
   std::unique_ptr<std::filebuf> _fb{nullptr};
+#ifdef EZL_ZLIB
+  std::unique_ptr<detail::GzStreamBuf> _gz{nullptr};
+#endif
   std::unique_ptr<std::istream> _is{nullptr};
+  std::unique_ptr<detail::MappedRange> _mf{nullptr};
+  bool _mapped{false};
+  const char* _mcur{nullptr};
+  const char* _rowBegin{nullptr};
+  const char* _rowEnd{nullptr};
+  long long _mbyte{0};
+  detail::DelimSet _colDelims;
+  detail::DelimSet _rowDelims;
+  std::vector<detail::CharRange> _tokens;
+  std::vector<detail::CharRange> _tokensSlct;
+  std::vector<std::string> _vstr;
+  std::vector<std::string> _vstrSlct;
   bool _isMask;
   int _idealSize;
+  std::vector<int> _dropSorted;
+  std::vector<int> _slotOrig;  // index in the row read for each column cast
+  std::vector<int> _slotOf;  // inverse of the above till the last column
+  int _lastCol{-1};
   long long _rBeginFile;
   long long _rEndFile;
   long long _rBeginByte{0};
   long long _rEndByte{0};
   size_t _rowsRead{0};
   int _pos {-1};
+  bool _tillEOF{false};  // tillEOF or files that are read whole in this run
+  bool _threaded{false};
+  std::vector<I> _batch;
+  bool _isEnd{false};
+  std::vector<char> _blk;
+  size_t _bpos{0};
+  long long _blkByte{0};
+  bool _fileDone{true};
+  std::string _carry;
+  std::shared_ptr<std::vector<char>> _unreadable;
+  std::unique_ptr<detail::BatchQueue<char>> _reader{nullptr};
+  FileStats _stats;
+  bool _isDynamic{false};
+  detail::ChunkQueue _queue;
+  std::vector<std::string> _allFiles;
+  std::vector<long long> _allSizes;
+  std::unique_ptr<detail::FromBinary<I>> _fromCache{nullptr};
+  std::unique_ptr<std::ofstream> _cacheOs{nullptr};
+  detail::BinaryColumns<I> _cacheCols;
+  std::string _cachePath;
+  std::string _cacheKey;
+  // last, so that the threads are stopped before the rest is destroyed
+  std::unique_ptr<detail::BatchQueue<I>> _pipe{nullptr};
 };
 
 template <class... Is>
@@ -0,0 +1,602 @@
+/*!
+ * @file
+ * class FromLammps, unit for loading the atoms from lammps dump files.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+
+#ifndef FROMLAMMPS_EZL_H
+#define FROMLAMMPS_EZL_H
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/range/iterator_range.hpp>
+
+#include <ezl/helper/DelimSet.hpp>
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/MappedRange.hpp>
+#include <ezl/helper/meta/lexCastTuple.hpp>
+#include <ezl/helper/rootShare.hpp>
+#include <ezl/helper/vglob.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Lines of a lammps dump in memory, used by the index and the reader.
+ * */
+struct LammpsLines {
+  // end of the line beginning at `it`, i.e. the '\n' or `last`.
+  static const char* eol(const char* it, const char* last) {
+    auto p = (const char*)std::memchr(it, '\n', last - it);
+    return p ? p : last;
+  }
+
+  // beginning of the line after the one ending at `eol`.
+  static const char* next(const char* eol, const char* last) {
+    return (eol < last) ? eol + 1 : last;
+  }
+
+  // beginning of the line `n` lines after the one beginning at `it`.
+  static const char* skip(const char* it, const char* last, long long n) {
+    for (; n > 0 && it < last; --n) it = next(eol(it, last), last);
+    return it;
+  }
+
+  // if the line [first, last) is `ITEM: <name>` with anything after it.
+  static bool isItem(const char* first, const char* last, const char* name) {
+    static const char item[] = "ITEM: ";
+    const size_t n = std::strlen(name);
+    const size_t len = sizeof(item) - 1;
+    return size_t(last - first) >= len + n &&
+           std::memcmp(first, item, len) == 0 &&
+           std::memcmp(first + len, name, n) == 0;
+  }
+
+  // value of the line [first, last) without the spaces around it.
+  static bool value(const char* first, const char* last, long long& out) {
+    while (first < last && (*first == ' ' || *first == '\t')) ++first;
+    while (last > first && (last[-1] == ' ' || last[-1] == '\t' ||
+                            last[-1] == '\r')) {
+      --last;
+    }
+    return first != last && meta::parseField(first, last, out);
+  }
+};
+
+/*!
+ * @ingroup helper
+ * Byte offsets of the timesteps in a lammps dump file, i.e. of the
+ * `ITEM: TIMESTEP` lines. The index is built in memory by scanning the
+ * dump. If asked, it is kept in a sidecar file with the size and modified
+ * time of the dump, next to the dump (`<dump>.steps`) or in a directory of
+ * choice, and is built again if either differs. If the sidecar can not be
+ * written the index in memory is used as it is.
+ * */
+struct LammpsIndex {
+  std::string fname;
+  long long size{0};
+  std::vector<long long> steps;
+  std::vector<long long> offsets;
+
+  template <class Archive>
+  void serialize(Archive& ar, const unsigned int) {
+    ar & fname & size & steps & offsets;
+  }
+
+  /*!
+   * name of the sidecar of the dump `fname`, next to it or in `dir`. In a
+   * directory the name has the hash of the path of the dump, so that dumps
+   * with the same name in different directories do not share the sidecar.
+   * */
+  static std::string sidecar(const std::string& fname,
+                             const std::string& dir = "") {
+    if (dir.empty()) return fname + ".steps";
+    auto base = fname.substr(fname.find_last_of('/') + 1);
+    return dir + "/" + base + "." +
+           std::to_string(std::hash<std::string>{}(fname)) + ".steps";
+  }
+
+  // bytes [begin, end) of the timestep at index i.
+  long long begin(size_t i) const { return offsets[i]; }
+  long long end(size_t i) const {
+    return (i + 1 < offsets.size()) ? offsets[i + 1] : size;
+  }
+
+  /*!
+   * builds the index of the file by scanning the headers, the atom lines are
+   * skipped by their count. With `isSidecar` it is loaded from the sidecar
+   * in `dir` (see `sidecar`) if it is up to date, else the sidecar is written
+   * after the scan.
+   * @return false if the file can not be read.
+   * */
+  bool load(const std::string& name, bool isSidecar = false,
+            const std::string& dir = "") {
+    fname = name;
+    steps.clear();
+    offsets.clear();
+    struct stat st;
+    if (::stat(fname.c_str(), &st) != 0) return false;
+    size = st.st_size;
+    const auto head = "ezl lammps index 1 " + std::to_string(size) + " " +
+                      std::to_string(st.st_mtime);
+    const auto side = sidecar(fname, dir);
+    if (isSidecar) {
+      std::ifstream in(side);
+      std::string line;
+      if (std::getline(in, line) && line == head) {
+        long long step, offset;
+        while (in >> step >> offset) {
+          steps.push_back(step);
+          offsets.push_back(offset);
+        }
+        return true;
+      }
+    }
+    MappedRange mf;
+    if (!mf.open(fname)) return false;
+    _scan(mf.begin(), mf.end());
+    if (!isSidecar) return true;
+    if (!dir.empty()) ::mkdir(dir.c_str(), 0755);  // fails if it exists
+    std::ofstream out(side);
+    if (out) {
+      out << head << '\n';
+      for (size_t i = 0; i < steps.size(); ++i) {
+        out << steps[i] << ' ' << offsets[i] << '\n';
+      }
+      out.close();
+    }
+    if (!out) {
+      Karta::inst().log("can not write lammps index: " + side +
+                        ", using it from memory.", LogMode::info);
+      std::remove(side.c_str());  // partly written
+    }
+    return true;
+  }
+
+private:
+  void _scan(const char* first, const char* last) {
+    using L = LammpsLines;
+    long long nAtoms = 0;
+    auto it = first;
+    while (it < last) {
+      auto eol = L::eol(it, last);
+      auto next = L::next(eol, last);
+      if (L::isItem(it, eol, "TIMESTEP")) {
+        long long step;
+        if (L::value(next, L::eol(next, last), step)) {
+          steps.push_back(step);
+          offsets.push_back(it - first);
+        }
+      } else if (L::isItem(it, eol, "NUMBER OF ATOMS")) {
+        if (!L::value(next, L::eol(next, last), nAtoms)) nAtoms = 0;
+      } else if (L::isItem(it, eol, "ATOMS")) {
+        next = L::skip(next, last, nAtoms);
+      }
+      it = next;
+    }
+  }
+};
+
+// number of columns in the file for a column type of the row.
+template <class T> struct LammpsTokens {
+  static constexpr size_t value = 1;
+};
+template <class T, size_t N> struct LammpsTokens<std::array<T, N>> {
+  static constexpr size_t value = N;
+};
+
+// number of columns in the file for the first N column types of the row.
+template <class I, size_t N> struct LammpsRowTokens {
+  static constexpr size_t value =
+      LammpsTokens<std::tuple_element_t<N - 1, I>>::value +
+      LammpsRowTokens<I, N - 1>::value;
+};
+template <class I> struct LammpsRowTokens<I, 0> {
+  static constexpr size_t value = 0;
+};
+
+/*!
+ * @ingroup algorithms
+ * function object for loading the atoms of lammps dump files, to be used with
+ * rise. The last column of the row is the timestep and the rest are the
+ * columns of the atom lines, the first ones or the ones selected with `cols`.
+ *
+ * The headers are parsed as they come, i.e. `ITEM: TIMESTEP` and
+ * `ITEM: NUMBER OF ATOMS` give the timestep and the count of the atom lines
+ * after `ITEM: ATOMS`, rest of the items are skipped. The atom lines are
+ * split in place of the memory mapped file and the columns are parsed
+ * straight to their type.
+ *
+ * The byte offsets of the timesteps are indexed by the first process of the
+ * unit (see `LammpsIndex`) and sent to the rest. The timesteps, whole, are
+ * divided between the processes by their size, and the ones not in the range
+ * given with `timesteps` are not read at all.
+ *
+ * Example usage:
+ * @code
+ * // id, coords and timestep of the atoms in timesteps 1000 to 5000
+ * rise(fromLammps<int, std::array<float, 3>, int>("dump*.txt")
+ *        .cols({1, 3, 4, 5}).timesteps(1000, 5000))
+ * @endcode
+ * */
+template <class I>
+class FromLammps {
+public:
+  static constexpr size_t nCols = std::tuple_size<I>::value;
+  using Step = std::tuple_element_t<nCols - 1, I>;
+  // number of columns of the atom lines in the row, i.e. except timestep.
+  static constexpr size_t nTokens = LammpsRowTokens<I, nCols - 1>::value;
+
+  FromLammps(std::string fpat) : _fpat{fpat} {}
+
+  FromLammps(std::vector<std::string> fnames) : _flist{fnames} {}
+
+  /*!
+   * columns of the atom lines to select, starting from 1. By default the
+   * first columns are taken in the order.
+   * */
+  auto cols(std::vector<int> c) && {
+    _cols = c;
+    return std::move(*this);
+  }
+  /*!
+   * columns of the atom lines to select, starting from 1. By default the
+   * first columns are taken in the order.
+   * */
+  auto& cols(std::vector<int> c) & {
+    _cols = c;
+    return *this;
+  }
+  /*!
+   * reads only the timesteps in [first, last], the rest are seeked over
+   * using the index.
+   * */
+  auto timesteps(long long first, long long last) && {
+    _stepFirst = first;
+    _stepLast = last;
+    return std::move(*this);
+  }
+  /*!
+   * reads only the timesteps in [first, last], the rest are seeked over
+   * using the index.
+   * */
+  auto& timesteps(long long first, long long last) & {
+    _stepFirst = first;
+    _stepLast = last;
+    return *this;
+  }
+  /*!
+   * whether to split the timesteps among available processes.
+   * */
+  auto split(bool isSplit = true) && {
+    _isSplit = isSplit;
+    return std::move(*this);
+  }
+  /*!
+   * whether to split the timesteps among available processes.
+   * */
+  auto& split(bool isSplit = true) & {
+    _isSplit = isSplit;
+    return *this;
+  }
+  /*!
+   * whether to keep the index in a sidecar file next to the dump, so that
+   * it is not built again the next time. By default the index is built in
+   * memory for each run and nothing is written.
+   * */
+  auto sidecar(bool isSidecar = true) && {
+    _isSidecar = isSidecar;
+    return std::move(*this);
+  }
+  /*!
+   * whether to keep the index in a sidecar file next to the dump, so that
+   * it is not built again the next time. By default the index is built in
+   * memory for each run and nothing is written.
+   * */
+  auto& sidecar(bool isSidecar = true) & {
+    _isSidecar = isSidecar;
+    return *this;
+  }
+  /*!
+   * keeps the index in a sidecar file in the directory `dir` rather than
+   * next to the dump, e.g. if the dumps are read-only.
+   * */
+  auto indexDir(std::string dir) && {
+    _isSidecar = true;
+    _indexDir = std::move(dir);
+    return std::move(*this);
+  }
+  /*!
+   * keeps the index in a sidecar file in the directory `dir` rather than
+   * next to the dump, e.g. if the dumps are read-only.
+   * */
+  auto& indexDir(std::string dir) & {
+    _isSidecar = true;
+    _indexDir = std::move(dir);
+    return *this;
+  }
+  auto limitFiles(size_t count) && {
+    _limitFiles = count;
+    return std::move(*this);
+  }
+  auto& limitFiles(size_t count) & {
+    _limitFiles = count;
+    return *this;
+  }
+  /*!
+   * called by rise to pass process information before running of the dataflow
+   * */
+  void operator () (const int& pos, const std::vector<int>& procs) {
+    auto indices = rootShare(pos, procs, [this] {
+      auto names = _fpat.empty() ? _flist : vglob(_fpat, _limitFiles);
+      std::vector<LammpsIndex> res(names.size());
+      for (size_t i = 0; i < names.size(); ++i) {
+        if (!res[i].load(names[i], _isSidecar, _indexDir)) {
+          Karta::inst().log("can not open file: " + names[i],
+                            LogMode::warning);
+        }
+      }
+      return res;
+    });
+    if (!_fpat.empty() && indices.empty()) {
+      Karta::inst().log("No file found for pattern: " + _fpat,
+                        LogMode::warning);
+    }
+    _maxCol = 0;
+    for (auto it : _cols) _maxCol = std::max(_maxCol, it);
+    if (!_cols.empty() && _cols.size() != nTokens) {
+      Karta::inst().log("number of lammps cols is not same as the row "
+                        "columns", LogMode::warning);
+    }
+    if (_isSplit) {
+      _share(indices, pos, int(procs.size()));
+    } else {
+      _share(indices, 0, 1);
+    }
+    _cur = 0;
+    _atomsLeft = 0;
+    _mf.reset();
+  }
+  /*!
+   * called by rise for pulling data.
+   * */
+  auto operator () () {
+    _more = true;
+    while (true) {
+      if (!_atomsLeft && !_nextAtoms()) {
+        _more = false;
+        break;
+      }
+      if (_atom()) break;
+    }
+    return std::tie(_out, _more);
+  }
+
+private:
+  // contiguous timesteps [begin, end) of a file read by the process.
+  struct Share {
+    std::string fname;
+    long long begin;
+    long long end;
+  };
+
+  bool _isStep(long long step) const {
+    return step >= _stepFirst && step <= _stepLast;
+  }
+
+  // a timestep belongs to the process in whose share of the total bytes of
+  // the selected timesteps it begins, adjacent ones are read as one.
+  void _share(const std::vector<LammpsIndex>& indices, int pos, int nProc) {
+    auto total = 0LL;
+    for (const auto& idx : indices) {
+      for (size_t i = 0; i < idx.steps.size(); ++i) {
+        if (_isStep(idx.steps[i])) total += idx.end(i) - idx.begin(i);
+      }
+    }
+    nProc = std::max(nProc, 1);
+    auto share = total / nProc;
+    auto begin = (pos > 0) ? share * pos : 0LL;
+    auto end = (pos < nProc - 1) ? share * (pos + 1) : total;
+    _shares.clear();
+    auto preSize = 0LL;
+    for (const auto& idx : indices) {
+      auto isAdjacent = false;
+      for (size_t i = 0; i < idx.steps.size(); ++i) {
+        if (!_isStep(idx.steps[i])) {
+          isAdjacent = false;
+          continue;
+        }
+        if (preSize >= begin && preSize < end) {
+          if (isAdjacent) {
+            _shares.back().end = idx.end(i);
+          } else {
+            _shares.push_back(Share{idx.fname, idx.begin(i), idx.end(i)});
+          }
+          isAdjacent = true;
+        } else {
+          isAdjacent = false;
+        }
+        preSize += idx.end(i) - idx.begin(i);
+      }
+    }
+  }
+
+  // reads the headers till the atoms of a timestep in range.
+  bool _nextAtoms() {
+    using L = LammpsLines;
+    while (_cur < _shares.size()) {
+      if (!_mf && !_openFile()) {
+        ++_cur;
+        continue;
+      }
+      while (_it < _end) {
+        auto eol = L::eol(_it, _last);
+        auto next = L::next(eol, _last);
+        if (L::isItem(_it, eol, "TIMESTEP")) {
+          _isStepRead = L::value(next, L::eol(next, _last), _step);
+          next = L::next(L::eol(next, _last), _last);
+        } else if (L::isItem(_it, eol, "NUMBER OF ATOMS")) {
+          if (!L::value(next, L::eol(next, _last), _nAtoms)) _nAtoms = 0;
+          next = L::next(L::eol(next, _last), _last);
+        } else if (L::isItem(_it, eol, "ATOMS")) {
+          _it = next;
+          if (!_isStepRead) {
+            // not in the index either, see `LammpsIndex::_scan`.
+            Karta::inst().log("skipping atoms with no valid timestep in file " +
+                              _fname, LogMode::warning);
+          } else if (_isStep(_step) && _nAtoms > 0) {
+            std::get<nCols - 1>(_out) = Step(_step);
+            _atomsLeft = _nAtoms;
+            return true;
+          }
+          _it = L::skip(_it, _last, _nAtoms);
+          continue;
+        }
+        _it = next;
+      }
+      ++_cur;
+      if (_cur == _shares.size() || _shares[_cur].fname != _fname) {
+        _mf.reset();
+      } else {
+        _seek();
+      }
+    }
+    return false;
+  }
+
+  // parses the next atom line, false if it is not a valid row.
+  bool _atom() {
+    using L = LammpsLines;
+    if (_it >= _last || L::isItem(_it, L::eol(_it, _last), "")) {
+      Karta::inst().log("fewer atoms than their number in timestep " +
+                        std::to_string(_step) + " of file " + _fname,
+                        LogMode::warning);
+      _atomsLeft = 0;
+      return false;
+    }
+    --_atomsLeft;
+    auto eol = L::eol(_it, _last);
+    auto first = _it;
+    _it = L::next(eol, _last);
+    auto n = size_t(0);
+    if (_cols.empty()) {
+      _slct.resize(nTokens);
+      _delims.tokens(first, eol, [this, &n](const char* b, const char* e) {
+        _slct[n++] = CharRange{b, e};
+        return n < nTokens;
+      });
+    } else {
+      _tokens.clear();
+      _delims.tokens(first, eol, [this](const char* b, const char* e) {
+        _tokens.emplace_back(b, e);
+        return int(_tokens.size()) < _maxCol;
+      });
+      if (int(_tokens.size()) < _maxCol) return false;
+      _slct.resize(_cols.size());
+      for (auto c : _cols) {
+        if (c > 0) _slct[n++] = _tokens[c - 1];
+      }
+    }
+    if (n != nTokens) return false;
+    auto it = std::end(_slct);
+    using T = std::tuple_element_t<nCols - 2, I>;
+    return meta::LexCastImpl<nCols - 2, I, T>::apply(it, _out, true);
+  }
+
+  bool _openFile() {
+    _fname = _shares[_cur].fname;
+    _mf = std::make_unique<MappedRange>();
+    if (!_mf->open(_fname)) {
+      Karta::inst().log("can not open file: " + _fname, LogMode::warning);
+      _mf.reset();
+      return false;
+    }
+    _last = _mf->end();
+    _seek();
+    return true;
+  }
+
+  void _seek() {
+    const auto& sh = _shares[_cur];
+    auto size = _last - _mf->begin();
+    _it = _mf->begin() + std::min(sh.begin, (long long)size);
+    _end = _mf->begin() + std::min(sh.end, (long long)size);
+    _isStepRead = false;
+    _nAtoms = 0;
+  }
+
+  using CharRange = boost::iterator_range<const char*>;
+
+  std::string _fpat;
+  std::vector<std::string> _flist;
+  std::vector<int> _cols;
+  int _maxCol{0};
+  long long _stepFirst{std::numeric_limits<long long>::min()};
+  long long _stepLast{std::numeric_limits<long long>::max()};
+  bool _isSplit{true};
+  bool _isSidecar{false};
+  std::string _indexDir;
+  size_t _limitFiles{0};
+  std::vector<Share> _shares;
+  size_t _cur{0};
+  std::string _fname;
+  std::unique_ptr<MappedRange> _mf;
+  const char* _it{nullptr};
+  const char* _end{nullptr};
+  const char* _last{nullptr};
+  long long _step{0};
+  bool _isStepRead{false};
+  long long _nAtoms{0};
+  long long _atomsLeft{0};
+  DelimSet _delims{" \t\r"};
+  std::vector<CharRange> _tokens;
+  std::vector<CharRange> _slct;
+  I _out;
+  bool _more{true};
+};
+} // namespace detail
+
+/*!
+ * ctor function for FromLammps with a glob pattern for the files. The last
+ * column is the timestep.
+ * */
+template <class... Is>
+auto fromLammps(std::string fpat) {
+  static_assert(sizeof...(Is) > 1, "a column of the atoms and timestep "
+                                   "are needed.");
+  return detail::FromLammps<std::tuple<Is...>>{fpat};
+}
+
+/*!
+ * ctor function for FromLammps with a list of the files. The last column is
+ * the timestep.
+ * */
+template <class... Is>
+auto fromLammps(std::vector<std::string> fnames) {
+  static_assert(sizeof...(Is) > 1, "a column of the atoms and timestep "
+                                   "are needed.");
+  return detail::FromLammps<std::tuple<Is...>>{fnames};
+}
+
+} // namespace ezl
+
+#endif // !FROMLAMMPS_EZL_H
@@ -13,12 +13,19 @@
 #ifndef IO_EZL_ALGO_H
 #define IO_EZL_ALGO_H
 
+#include <memory>
 #include <tuple>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <sys/stat.h>
 
+#include <ezl/helper/ChunkQueue.hpp>
+#include <ezl/helper/RowRange.hpp>
+#include <ezl/helper/rootShare.hpp>
+#include <ezl/helper/sizeShare.hpp>
 #include <ezl/helper/vglob.hpp>
+#include <ezl/helper/meta/funcInvoke.hpp>
 
 namespace ezl {
 namespace detail {
@@ -118,9 +125,9 @@ public:
   /*!
    * ctor
    * @param fpat file glob pattern, such as "*.txt"
-   * @param isSplit if set true the the file list is partitioned equally
-   *                among the available processes, else all the processes
-   *                work on full list.
+   * @param isSplit if set true the the file list is partitioned among the
+   *                available processes such that each gets about the same
+   *                total size, else all the processes work on full list.
    * */
   fromFileNames(std::string fpat, bool isSplit = true)
       : _fpat{fpat}, _isSplit{isSplit} {}
@@ -128,8 +135,18 @@ public:
    * called by rise to pass process information before running of the dataflow
    * */
   auto operator () (const int& pos, const std::vector<int>& procs) { 
-    _fnames = detail::vglob(_fpat, _limitFiles);
-    if(!_fnames.empty() && _isSplit) _share(pos, procs.size());
+    std::vector<long long> sizes;
+    std::tie(_fnames, sizes) = detail::rootShare(pos, procs, [this] {
+      auto fnames = detail::vglob(_fpat, _limitFiles);
+      std::vector<long long> lens;
+      for (const auto& it : fnames) {
+        if (!_isSplit) break;
+        struct stat st;
+        lens.push_back((::stat(it.c_str(), &st) == 0) ? st.st_size : 0);
+      }
+      return std::make_pair(fnames, lens);
+    });
+    if(!_fnames.empty() && _isSplit) _share(pos, procs.size(), sizes);
   }
   /*!
    * called by rise for pulling data.
@@ -174,25 +191,13 @@ public:
     return *this;
   }
 private:
-  void _share(int pos, size_t total) {
-    auto len = _fnames.size();
-    auto share = size_t(len / total);
-    if (share == 0) share = 1;
-    size_t rBeginFile = share * pos;
-    size_t rEndFile = (share * (pos + 1)) - 1;
-    if (rEndFile > (len - 1) || size_t(pos) == total - 1) {
-      rEndFile = len - 1;
-    }
-    if (rBeginFile > (len - 1)) {
-      _fnames.clear();
-    } else {
-      rEndFile -= rBeginFile;
-      for (size_t i = 0; i <= rEndFile; i++) {
-        _fnames[i] = _fnames[i + rBeginFile];
-      }
-      rBeginFile = 0;
-      _fnames.resize(rEndFile + 1);
+  // the files are divided balancing the total size for each process.
+  void _share(int pos, size_t total, const std::vector<long long>& sizes) {
+    auto files = detail::sizeShare(sizes, pos, total);
+    for (size_t i = 0; i < files.size(); i++) {
+      _fnames[i] = _fnames[files[i]];
     }
+    _fnames.resize(files.size());
   }
   std::string _fpat;
   bool _isSplit;
@@ -216,8 +221,20 @@ private:
  * ezl::rise(ezl::fromMem(a)).build();
  *
  * ezl::rise(ezl::fromMem(std::array<float, 2> {4., 2.}}, false))
+ *
+ * // no copy of the rows, the buffer is shared or viewed.
+ * auto p = std::make_shared<const std::vector<double>>(100, 1.);
+ * ezl::rise(ezl::fromMem(p, true)).build();
+ * ezl::rise(ezl::fromMem(p->data(), p->size(), true)).build();
  * @endcode
  *
+ * The rows are passed on in batches straight from the memory of the source.
+ * An rvalue source is moved in and a shared source is kept alive by the
+ * function object, while an lvalue source or a view of a pointer and length
+ * is to outlive the runs. In an iteration the buffer can be changed to the
+ * output of the last run without a copy, e.g.
+ * `buf.buffer(flow(fl).get())`, or swapped between two shared buffers.
+ *
  * */
 namespace detail {
 template <class T>
@@ -237,19 +254,39 @@ public:
     _vDataHandle = &source;
   }
   /*!
-  * ctor for rvalue source. The params are same as in lvalue ctor.
+  * ctor for rvalue source, that is moved in. The params are same as in
+  * lvalue ctor.
   * */
-  FromMem(const T &&source, bool isShard = false)
+  FromMem(T &&source, bool isShard = false)
       : _isSplit{isShard} {
     _isVal = true;
     _vDataVal = std::move(source);
     _vDataHandle = &_vDataVal;
   }
   /*!
+  * ctor for const rvalue source, that is copied.
+  * */
+  FromMem(const T &&source, bool isShard = false)
+      : _isSplit{isShard} {
+    _isVal = true;
+    _vDataVal = source;
+    _vDataHandle = &_vDataVal;
+  }
+  /*!
+  * ctor for a shared source, that is kept alive but not copied.
+  * */
+  FromMem(std::shared_ptr<const T> source, bool isShard = false)
+      : _isSplit{isShard} {
+    _isVal = false;
+    _vDataShared = std::move(source);
+    _vDataHandle = _vDataShared.get();
+  }
+  /*!
   * change buffer to get data from a variable (lvalue)
   * */
   auto buffer(const T &source) && {
     _isVal = false;
+    _vDataShared.reset();
     _vDataHandle = &source;
     return std::move(*this);
   }
@@ -258,27 +295,48 @@ public:
   * */
   auto& buffer(const T &source) & {
     _isVal = false;
+    _vDataShared.reset();
     _vDataHandle = &source;
     return *this;
   }
   /*!
-  * change buffer to get data from an instant list (rvalue)
+  * change buffer to get data from an instant list (rvalue), that is moved in.
   * */
-  auto buffer(const T &&source) && {
+  auto buffer(T &&source) && {
     _isVal = true;
+    _vDataShared.reset();
     _vDataVal = std::move(source);
     _vDataHandle = &_vDataVal;
     return std::move(*this);
   }
   /*!
-  * change buffer to get data from an instant list (rvalue)
+  * change buffer to get data from an instant list (rvalue), that is moved in.
   * */
-  auto& buffer(const T &&source) & {
+  auto& buffer(T &&source) & {
     _isVal = true;
+    _vDataShared.reset();
     _vDataVal = std::move(source);
     _vDataHandle = &_vDataVal;
     return *this;
   }
+  /*!
+  * change buffer to get data from a shared source without a copy.
+  * */
+  auto buffer(std::shared_ptr<const T> source) && {
+    _isVal = false;
+    _vDataShared = std::move(source);
+    _vDataHandle = _vDataShared.get();
+    return std::move(*this);
+  }
+  /*!
+  * change buffer to get data from a shared source without a copy.
+  * */
+  auto& buffer(std::shared_ptr<const T> source) & {
+    _isVal = false;
+    _vDataShared = std::move(source);
+    _vDataHandle = _vDataShared.get();
+    return *this;
+  }
   /*!
    * whether to split the data among available processes.
    * */
@@ -293,6 +351,25 @@ public:
     _isSplit = isSplit;
     return *this;
   }
+  /*!
+   * split the data in chunks of `chunk` rows that the processes take as they
+   * get done with the prior, for rows that take varying time. The order of
+   * rows is not kept. If chunk is zero there are `ChunkQueue::chunksPerProc`
+   * chunks for each process.
+   * */
+  auto dynamic(size_t chunk = 0) && {
+    _isDynamic = true;
+    _chunk = chunk;
+    return std::move(*this);
+  }
+  /*!
+   * split the data in chunks that the processes take as they get done.
+   * */
+  auto& dynamic(size_t chunk = 0) & {
+    _isDynamic = true;
+    _chunk = chunk;
+    return *this;
+  }
   /*!
    * called by rise to pass process information before running of the dataflow
    * */
@@ -301,6 +378,11 @@ public:
     if (_isVal) {
       _vDataHandle = &_vDataVal;
     }
+    if (_isDynamic) {
+      _queue.reset(pos, procs, _vDataHandle->size(), _chunk);
+      _cur = _last = std::begin(*_vDataHandle);
+      return;
+    }
     if(!_isSplit) {
       _cur = std::begin(*_vDataHandle);
       _last = std::end(*_vDataHandle);
@@ -311,18 +393,34 @@ public:
     _last = std::next(std::begin(*_vDataHandle), edges[1] - 1);
   }
   /*!
-   * called by rise for pulling data.
+   * called by rise for pulling data, gives the next batch of rows without
+   * copying them.
    * */
   auto operator () () {
-    auto res = std::tie((*_cur), _more); // no copies
-    ++_cur;
-    if (_cur > _last) { 
-      _more = false;
-      --_cur;
-    }
-    return res;
+    if (_isDynamic) _nextDynamic();
+    auto first = _cur;
+    for (size_t i = 0; i < batchRows && _cur != _last; ++i) ++_cur;
+    return makeRowRange(first, _cur);
   }
+
+  // number of rows passed in a batch.
+  static constexpr size_t batchRows = 1024;
+
 private:
+  // _last is the end of the chunk here.
+  void _nextDynamic() {
+    _queue.poll(batchRows);
+    size_t first, last;
+    while (_cur == _last && _more) {
+      if (_queue.next(first, last)) {
+        _cur = std::next(std::begin(*_vDataHandle), first);
+        _last = std::next(std::begin(*_vDataHandle), last);
+      } else {
+        _more = false;
+      }
+    }
+  }
+
   auto _share(int pos, int total, size_t len) {
     auto share = len / total;
     if (share == 0) share = 1;
@@ -337,12 +435,16 @@ private:
     return std::array<size_t, 2> {{first, last+1}};
   }
   T _vDataVal;
+  std::shared_ptr<const T> _vDataShared;
   const T* _vDataHandle;
   bool _isSplit;
   typename T::const_iterator _cur;
   typename T::const_iterator _last;
   bool _more {true};
   bool _isVal;
+  bool _isDynamic{false};
+  size_t _chunk{0};
+  ChunkQueue _queue;
 };
 
 /*!
@@ -357,6 +459,8 @@ private:
  * and second one gets [3, 4, 5, 6].
  *
  * rise(iota(3,5).split(false)).build();  // [3,4] to each process
+ *
+ * rise(iota(100).dynamic(10)).build();  // [0,10), [10,20)... on demand
  * @endcode
  *
  * */
@@ -371,6 +475,7 @@ public:
    * called by rise for pulling data.
    * */
   auto operator () () {
+    if (_isDynamic) _nextChunk();
     _cur++;
     return make_pair(std::tuple<T>{_cur - 1}, (_cur - 1) < _max);
   }
@@ -378,7 +483,11 @@ public:
    * called by rise to pass process information before running of the dataflow
    * */
   auto operator () (const int& pos, const std::vector<int>& procs) { 
-    if(_isSplit) {
+    if (_isDynamic) {
+      _queue.reset(pos, procs, _last > _first ? size_t(_last - _first) : 0,
+                   _chunk);
+      _cur = _max = _first;
+    } else if(_isSplit) {
       _share(pos, procs.size());
     } else {
       _cur = _first;
@@ -431,7 +540,35 @@ public:
     _isSplit = isSplit;
     return *this;
   }
+  /*!
+   * split the range in chunks of `chunk` numbers that the processes take as
+   * they get done with the prior, for numbers that take varying time. If
+   * chunk is zero there are `ChunkQueue::chunksPerProc` chunks for each
+   * process.
+   * */
+  auto dynamic(size_t chunk = 0) && {
+    _isDynamic = true;
+    _chunk = chunk;
+    return std::move(*this);
+  }
+  /*!
+   * split the range in chunks that the processes take as they get done.
+   * */
+  auto& dynamic(size_t chunk = 0) & {
+    _isDynamic = true;
+    _chunk = chunk;
+    return *this;
+  }
 private:
+  void _nextChunk() {
+    _queue.poll();
+    size_t first, last;
+    if (_cur == _max && _queue.next(first, last)) {
+      _cur = _first + T(first);
+      _max = _first + T(last);
+    }
+  }
+
   void _share(int pos, int total) {
     auto len = _last - _first;
     auto share = T(len / total);
@@ -447,16 +584,37 @@ private:
   T _first;
   T _last;
   bool _isSplit;
+  bool _isDynamic{false};
+  size_t _chunk{0};
+  ChunkQueue _queue;
 };
 } // namespace detail
 
 // a function to help in ctoring fromMem with template parameter deduction.
-template <class T>
+template <class T, class = std::enable_if_t<
+                       !std::is_pointer<std::decay_t<T>>::value &&
+                       !detail::meta::isSharedPtr<std::decay_t<T>>::value>>
 auto fromMem(T&& source, bool isSplit = false) {
   using cleanT = std::decay_t<T>;
   return detail::FromMem<cleanT> {std::forward<T>(source), isSplit};
 }
 
+// fromMem from a shared source, the rows are not copied.
+template <class T>
+auto fromMem(std::shared_ptr<T> source, bool isSplit = false) {
+  using cleanT = std::remove_const_t<T>;
+  return detail::FromMem<cleanT> {
+      std::shared_ptr<const cleanT>{std::move(source)}, isSplit};
+}
+
+// fromMem from a view of `n` rows at `data`, the rows are not copied and
+// are to outlive the runs.
+template <class T>
+auto fromMem(const T* data, size_t n, bool isSplit = false) {
+  return detail::FromMem<detail::RowRange<const T*>> {
+      detail::makeRowRange(data, data + n), isSplit};
+}
+
 // a function to help in ctoring fromMem with template parameter deduction.
 template <class T>
 auto fromMem(std::initializer_list<T> source, bool isSplit = false) {
@@ -487,6 +645,8 @@ auto iota(T first, T last, bool isSplit = true) {
  * .build();
  *
  * rise(kick(60, false)).build();  // 60 each, if run on two procs 120 total
+ *
+ * rise(kick(60).dynamic(5))  // chunks of 5 taken by the processes on demand
  * @endcode
  *
  * */
@@ -498,18 +658,27 @@ public:
   kick(size_t times = 1, bool isSplit = true)
       : _times{times}, _isSplit{isSplit} {}
   /*!
-   * called by rise for pulling data.
+   * called by rise for pulling data, gives a batch of the calls.
    * */
   auto operator () () {
-    ++_cur;
-    return make_pair(std::tuple<>{}, (_cur <= _max));
+    if (_isDynamic) _nextChunk();
+    auto n = std::min<size_t>(_max - _cur, size_t(batchRows));
+    _cur += n;
+    return detail::makeRowRange(std::begin(_rows), std::begin(_rows) + n);
   }
+
+  // number of calls passed in a batch.
+  static constexpr size_t batchRows = 1024;
   /*!
    * called by rise to pass process information before running of the dataflow
    * */
   auto operator () (const int& pos, const std::vector<int>& procs) { 
     _max = (_isSplit) ? _share(pos, procs.size()) : _times;
     _cur = 0;
+    if (_isDynamic) {
+      _queue.reset(pos, procs, _times, _chunk);
+      _max = 0;
+    }
   }
   /*!
    * reset the number of times to new value
@@ -539,7 +708,34 @@ public:
     _isSplit = isSplit;
     return *this;
   }
+  /*!
+   * split the times in chunks of `chunk` that the processes take as they get
+   * done with the prior, for calls that take varying time. If chunk is zero
+   * there are `ChunkQueue::chunksPerProc` chunks for each process.
+   * */
+  auto dynamic(size_t chunk = 0) && {
+    _isDynamic = true;
+    _chunk = chunk;
+    return std::move(*this);
+  }
+  /*!
+   * split the times in chunks that the processes take as they get done.
+   * */
+  auto& dynamic(size_t chunk = 0) & {
+    _isDynamic = true;
+    _chunk = chunk;
+    return *this;
+  }
 private:
+  void _nextChunk() {
+    _queue.poll(batchRows);
+    size_t first, last;
+    if (_cur == _max && _queue.next(first, last)) {
+      _cur = 0;
+      _max = last - first;
+    }
+  }
+
   size_t _share(int pos, int total) {
     auto share = size_t(_times / total);
     auto res = share;
@@ -549,9 +745,13 @@ private:
     return res;
   }
   size_t _times;
-  size_t _cur;
-  size_t _max;
+  size_t _cur{0};
+  size_t _max{0};
   bool _isSplit;
+  bool _isDynamic{false};
+  size_t _chunk{0};
+  detail::ChunkQueue _queue;
+  std::vector<std::tuple<>> _rows = std::vector<std::tuple<>>(batchRows);
 };
 
 } // namespace ezl
@@ -13,6 +13,7 @@
 #define DATAFLOWEXPR_EZL_H
 
 #include <functional>
+#include <stdexcept>
 
 #include <boost/functional/hash.hpp>
 
@@ -29,6 +30,8 @@
 #include <ezl/builder/ZipBuilder.hpp>
 
 #include <ezl/helper/Karta.hpp>
+#include <ezl/helper/RowStream.hpp>
+#include <ezl/helper/gatherRows.hpp>
 #include <ezl/helper/meta/slctTuple.hpp>
 #include <ezl/helper/meta/slct.hpp>
 #include <ezl/helper/meta/typeInfo.hpp>
@@ -51,42 +54,50 @@ public:
   // for adding map unit e.g. map([](int x) { return x * 2; })
   template <class F> auto map(F&& f) {
     auto curUnit = ((T *)this)->_buildUnit();
+    auto run = _fuseRunOf((T *)this, 0);
+    using R = typename decltype(run)::type;
     using I = typename decltype(curUnit)::element_type::otype;
     using nomask =
         typename meta::fillSlct<0, std::tuple_size<I>::value>::type;
     using O = typename meta::MapDefTypesNoSlct<I, F>::odefslct;
-    return MapBuilder<I, nomask, F, O, meta::slct<>, emptyHash, Fl>{
-      std::forward<F>(f), curUnit, _fl};
+    return MapBuilder<I, nomask, F, O, meta::slct<>, emptyHash, Fl, R>{
+        std::forward<F>(f), curUnit, _fl, emptyHash{}, run.len};
   }
   // for adding map unit with input column selection
   // e.g. map<3,1>([](int x, float y) { return y / x; })
   template <int N, int... Ns, class F> auto map(F&& f) {
     auto curUnit = ((T *)this)->_buildUnit();
+    auto run = _fuseRunOf((T *)this, 0);
+    using R = typename decltype(run)::type;
     using I = typename decltype(curUnit)::element_type::otype;
     using S = meta::saneSlct<std::tuple_size<I>::value, N, Ns...>;
     using O = typename meta::MapDefTypes<I, S, F>::odefslct;
-    return MapBuilder<I, S, F, O, meta::slct<>, emptyHash, Fl>{
-      std::forward<F>(f), curUnit, _fl};
+    return MapBuilder<I, S, F, O, meta::slct<>, emptyHash, Fl, R>{
+        std::forward<F>(f), curUnit, _fl, emptyHash{}, run.len};
   }
   // for adding filter unit e.g. filter(eq(0, 'e') || gt<1>(5))
   template <class F> auto filter(F&& f) {
     auto curUnit = ((T *)this)->_buildUnit();
+    auto run = _fuseRunOf((T *)this, 0);
+    using R = typename decltype(run)::type;
     using I = typename decltype(curUnit)::element_type::otype;
     using nomask =
         typename meta::fillSlct<0, std::tuple_size<I>::value>::type;
-    return FilterBuilder<I, nomask, F, nomask, meta::slct<>, emptyHash, Fl>{
-        std::forward<F>(f), curUnit, _fl};
+    return FilterBuilder<I, nomask, F, nomask, meta::slct<>, emptyHash, Fl, R>{
+        std::forward<F>(f), curUnit, _fl, emptyHash{}, run.len};
   }
   // for adding filter unit with input column selection
   // e.g. filter<3,1>(eq(0, 'e') || gt<1>(5))
   template <int N, int... Ns, class F> auto filter(F&& f) {
     auto curUnit = ((T *)this)->_buildUnit();
+    auto run = _fuseRunOf((T *)this, 0);
+    using R = typename decltype(run)::type;
     using I = typename decltype(curUnit)::element_type::otype;
     using S = meta::saneSlct<std::tuple_size<I>::value, N, Ns...>;
     using nomask =
         typename meta::fillSlct<0, std::tuple_size<I>::value>::type;
-    return FilterBuilder<I, S, F, nomask, meta::slct<>, emptyHash, 
-                         Fl>{std::forward<F>(f), curUnit, _fl};
+    return FilterBuilder<I, S, F, nomask, meta::slct<>, emptyHash, Fl, R>{
+        std::forward<F>(f), curUnit, _fl, emptyHash{}, run.len};
   }
   // zip with two different keys e.g. zip<key<4, 1>, key<3, 1>>(pipe)
   template <class K1, class K2, class Pre> auto zip(Pre pre) {
@@ -215,6 +226,112 @@ public:
     return get(procs, refresh);
   }
 
+  // builds the flow, runs it and returns the output rows of all the
+  // processes on the process with rank `root`, the rest get no rows. It is
+  // to be called by all the processes.
+  // @param root rank of the process to collect the rows on.
+  // @param procs Process request in terms of exact number of processes,
+  //    ratio of total processes or exact rank of processes in a vector<int>.
+  // @return returns the vector of tuple of output column types.
+  template <class Ptype>
+  auto getAt(int root, Ptype procs, bool refresh = true) {
+    auto buffer = get(procs, refresh);
+    gatherRows(buffer, root < 0 ? 0 : root);
+    return buffer;
+  }
+
+  // builds the flow, runs it and returns the output rows of all the
+  // processes on the process with rank `root`, the rest get no rows.
+  // @param lprocs optional process request as exact ranks in initializer_list<int>
+  // @return returns the vector of tuple of output column types.
+  auto getAt(int root, std::initializer_list<int> lprocs = {},
+             bool refresh = true) {
+    std::vector<int> procs(std::begin(lprocs), std::end(lprocs));
+    return getAt(root, procs, refresh);
+  }
+
+  // builds the flow, runs it and returns the output rows of all the
+  // processes on every process, in order of the ranks. It is to be called by
+  // all the processes.
+  // @param procs Process request in terms of exact number of processes,
+  //    ratio of total processes or exact rank of processes in a vector<int>.
+  // @return returns the vector of tuple of output column types.
+  template <class Ptype> auto getAll(Ptype procs, bool refresh = true) {
+    auto buffer = get(procs, refresh);
+    gatherRows(buffer);
+    return buffer;
+  }
+
+  // builds the flow, runs it and returns the output rows of all the
+  // processes on every process, in order of the ranks.
+  // @param lprocs optional process request as exact ranks in initializer_list<int>
+  // @return returns the vector of tuple of output column types.
+  auto getAll(std::initializer_list<int> lprocs = {}, bool refresh = true) {
+    std::vector<int> procs(std::begin(lprocs), std::end(lprocs));
+    return getAll(procs, refresh);
+  }
+
+  // builds the flow and runs it on a thread while the output rows are taken
+  // from the returned stream, in batches or by iterating over the rows, as
+  // they reach the end of the flow. See `RowStream`. With MPI the library
+  // needs to allow the calls from the thread of the flow, by making the
+  // environment as `ezl::Env env{argc, argv, false, true}`, else it throws
+  // std::logic_error.
+  // @param procs Process request in terms of exact number of processes,
+  //    ratio of total processes or exact rank of processes in a vector<int>.
+  // @param batchRows number of rows in a batch.
+  // @param depth number of batches kept waiting before the flow waits.
+  // @return RowStream of tuple of output column types.
+  template <class Ptype>
+  auto stream(Ptype procs, size_t batchRows = 1024, size_t depth = 4,
+              bool refresh = true) {
+    if (!Karta::inst().isThreaded()) {
+      throw std::logic_error("stream needs the flow to run on a thread, make "
+                             "ezl::Env with isThreaded.");
+    }
+    auto fl = build();
+    using I = typename decltype(fl)::element_type::otype;
+    using Row = typename meta::SlctTupleType<I>::type;
+    auto req = ProcReq{procs};
+    if (refresh) Karta::inst().refresh();
+    if (batchRows == 0) batchRows = 1;
+    // the thread of the flow works for the rank of the caller.
+    auto rank = Karta::rankOf();
+    return RowStream<Row>{[fl, req, batchRows, rank](auto& push) {
+      Karta::actAs(rank);
+      if (fl->isEmpty()) return;
+      std::vector<Row> batch;
+      auto isOpen = true;
+      auto dumper = [&batch, &isOpen, &push, batchRows](Row row) {
+        if (!isOpen) return false;
+        batch.emplace_back(std::move(row));
+        if (batch.size() >= batchRows) {
+          isOpen = push(std::move(batch));
+          batch.clear();
+        }
+        return false;
+      };
+      using nomask =
+          typename meta::fillSlct<0, std::tuple_size<I>::value>::type;
+      auto dumpfl = std::make_shared<Filter<I, nomask, decltype(dumper),
+                                            nomask>>(dumper);
+      fl->next(dumpfl, fl);
+      Karta::inst().run(dumpfl.get(), req);
+      fl->unNext(dumpfl.get());
+      if (isOpen && !batch.empty()) push(std::move(batch));
+    }, depth};
+  }
+
+  // builds the flow and runs it on a thread while the output rows are taken
+  // from the returned stream.
+  // @param lprocs optional process request as exact ranks in initializer_list<int>
+  // @return RowStream of tuple of output column types.
+  auto stream(std::initializer_list<int> lprocs = {}, size_t batchRows = 1024,
+              size_t depth = 4, bool refresh = true) {
+    std::vector<int> procs(std::begin(lprocs), std::end(lprocs));
+    return stream(procs, batchRows, depth, refresh);
+  }
+
   // builds the current unit but as a branch, any expression that appears after is
   // called on one prior unit. e.g. if a new unit is added afterwards it gets
   // output data stream from the one prior unit. Generally usuful for aggregating
@@ -277,6 +394,14 @@ protected:
   Flow<Fl, std::nullptr_t> _fl;
 
 private:
+  // stages of the unit built by a map or filter builder for fusing the next
+  // map or filter unit with it, none for other builders.
+  template <class U>
+  static auto _fuseRunOf(U* u, int) -> decltype(u->_fuseRun()) {
+    return u->_fuseRun();
+  }
+  template <class U>
+  static auto _fuseRunOf(U*, long) { return FuseRun<StageList<>>{0}; }
   // zip for different types of sources
   template <class K1, class K2, class nomask, class Cur, class Pre>
   auto _zipImpl(Cur curUnit, Pre pre, std::false_type) {
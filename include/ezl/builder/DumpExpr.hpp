@@ -14,6 +14,7 @@
 
 #include <ezl/helper/meta/slctTuple.hpp>
 #include <ezl/units/Dump.hpp>
+#include <ezl/units/DumpBinary.hpp>
 
 namespace ezl {
 namespace detail {
@@ -33,11 +34,30 @@ protected:
 
   template <class I>
   auto _postBuild(I& obj) {
+    using otype = typename std::decay_t<decltype(obj)>::element_type::otype;
     if (_name != defStr) {
-      auto dObj = std::make_shared<
-          Dump<typename std::decay_t<decltype(obj)>::element_type::otype>>(_name, _header);
+      auto dObj = std::make_shared<Dump<otype>>(_name, _header, _format,
+                                                 1 << 20, _isShared);
       obj->next(dObj, obj);
     }
+    if (!_binName.empty()) {
+      _addBinary(obj, std::integral_constant<bool,
+                                             BinaryRow<otype>::supported>{});
+    }
+  }
+
+  template <class I>
+  void _addBinary(I& obj, std::true_type) {
+    using otype = typename std::decay_t<decltype(obj)>::element_type::otype;
+    auto bObj = std::make_shared<DumpBinary<otype>>(_binName);
+    obj->next(bObj, obj);
+  }
+
+  template <class I>
+  void _addBinary(I&, std::false_type) {
+    Karta::inst().log("dumpBinary needs columns that are trivially copyable "
+                      "or string, not dumping to " + _binName,
+                      LogMode::warning);
   }
 
 public:
@@ -50,6 +70,36 @@ public:
     return ((T *)this)->_self();
   }
   
+  // separators of the columns and the rows for dump, e.g.
+  // dumpFormat("\t") for tab separated columns. The default is like
+  // (1, 2.5, abc) for a row.
+  // @param colSep separator between the columns
+  // @param rowSep separator after each row, defaults to new line
+  // @param open optional text before the first column of each row
+  // @param close optional text after the last column of each row
+  auto& dumpFormat(std::string colSep, std::string rowSep = "\n",
+                   std::string open = "", std::string close = "") {
+    _format = TextFormat{open, colSep, close, rowSep};
+    return ((T *)this)->_self();
+  }
+
+  // whether the processes dump to one file in the order of their positions
+  // rather than to a file each with rank in the name, with MPI-IO. The rows
+  // of a process are kept till the end of data, those beyond the buffer in
+  // a temporary file `<fname>.<pos>.part` of each process next to the
+  // output, which is removed after the write.
+  auto& dumpShared(bool isShared = true) {
+    _isShared = isShared;
+    return ((T *)this)->_self();
+  }
+
+  // get the output in a binary columnar file that can be read by fromBinary
+  // @param name file name
+  auto& dumpBinary(std::string name) {
+    _binName = name;
+    return ((T *)this)->_self();
+  }
+
   // select output columns by index starting from 1 e.g. cols<3, 1>() selects
   // third and first column
   template <int... Os> auto cols() {
@@ -64,18 +114,25 @@ public:
     return ((T *)this)->colsSlct(NO{});
   }
 
-  // get name and header for dump
-  auto dumpProps() { return std::tie(_name, _header); }
+  // get name, header, format and sharing for dump and name for binary dump
+  auto dumpProps() {
+    return std::tie(_name, _header, _binName, _format, _isShared);
+  }
 
-  // set name and header for dump
-  void dumpProps(std::tuple<const std::string&, const std::string&> props) {
-    std::tie(_name, _header) = props;
+  // set name, header, format and sharing for dump and name for binary dump
+  void dumpProps(std::tuple<const std::string&, const std::string&,
+                            const std::string&, const TextFormat&,
+                            const bool&> props) {
+    std::tie(_name, _header, _binName, _format, _isShared) = props;
   }
 
 private:
   const std::string defStr{"__none__"};
   std::string _name{defStr};
   std::string _header{""};
+  std::string _binName{""};
+  TextFormat _format;
+  bool _isShared{false};
 };
 }
 } // namespace ezl ezl::detail
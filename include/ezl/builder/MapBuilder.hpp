@@ -15,12 +15,13 @@
 #include <memory>
 
 #include <ezl/helper/meta/typeInfo.hpp>
+#include <ezl/units/Fused.hpp>
 #include <ezl/units/Map.hpp>
 
 
-#define MSUPER DataFlowExpr<MapBuilder<I, S, F, O, P, H, A>, A>,       \
-               PrllExpr<MapBuilder<I, S, F, O, P, H, A>>,              \
-               DumpExpr<MapBuilder<I, S, F, O, P, H, A>, O>
+#define MSUPER DataFlowExpr<MapBuilder<I, S, F, O, P, H, A, R>, A>,       \
+               PrllExpr<MapBuilder<I, S, F, O, P, H, A, R>>,              \
+               DumpExpr<MapBuilder<I, S, F, O, P, H, A, R>, O>
 
 namespace ezl {
 template <class T> class Source;
@@ -29,6 +30,9 @@ namespace detail {
 template <class T, class A> struct DataFlowExpr;
 template <class T> struct PrllExpr;
 template <class T, class O> struct DumpExpr;
+template <class I, class S, class F, class O, class P, class H, class A,
+          class R = StageList<>>
+struct MapBuilder;
 
 /*!
  * @ingroup builder
@@ -36,12 +40,14 @@ template <class T, class O> struct DumpExpr;
  *
  * Employs CRTP
  * */
-template <class I, class S, class F, class O, class P, class H, class A>
+template <class I, class S, class F, class O, class P, class H, class A,
+          class R>
 struct MapBuilder : MSUPER {
 public:
   MapBuilder(F &&f, std::shared_ptr<Source<I>> prev, Flow<A, std::nullptr_t> fl,
-             H h = H{})
-      : _func{std::forward<F>(f)}, _prev{prev}, _h{std::forward<H>(h)} {
+             H h = H{}, size_t fuseLen = 0)
+      : _func{std::forward<F>(f)}, _prev{prev}, _h{std::forward<H>(h)},
+        _fuseLen{fuseLen} {
     this->mode(llmode::shard); 
     this->_fl = fl;
   }
@@ -56,8 +62,8 @@ public:
   template <int i, int... is, class NH = meta::HashType<I, i, is...>>
   auto partitionBy(NH &&nh = NH{}) {
     using NP = meta::saneSlct<std::tuple_size<I>::value, i, is...>;
-    auto temp = MapBuilder<I, S, F, O, NP, NH, A>{std::forward<F>(this->_func),
-        std::move(this->_prev), std::move(this->_fl), std::forward<NH>(nh)};
+    auto temp = MapBuilder<I, S, F, O, NP, NH, A, R>{std::forward<F>(this->_func),
+        std::move(this->_prev), std::move(this->_fl), std::forward<NH>(nh), _fuseLen};
     this->_props.isPrll = true;
     temp.prllProps(this->prllProps());
     temp.dumpProps(this->dumpProps());
@@ -74,8 +80,8 @@ public:
    * */
   template <class NO>
   auto colsSlct(NO = NO{}) {  // NOTE: while calling with T cast arg. is req
-    auto temp = MapBuilder<I, S, F, NO, P, H, A>{std::forward<F>(this->_func),
-        std::move(this->_prev), std::move(this->_fl), std::forward<H>(this->_h)};
+    auto temp = MapBuilder<I, S, F, NO, P, H, A, R>{std::forward<F>(this->_func),
+        std::move(this->_prev), std::move(this->_fl), std::forward<H>(this->_h), _fuseLen};
     temp.prllProps(this->prllProps());
     temp.dumpProps(this->dumpProps());
     return temp;
@@ -116,20 +122,37 @@ public:
 
   /*!
    * internally called by build
-   * @return shared_ptr of Filter object.
+   * @return shared_ptr of the unit, a `Fused` unit of the Map stage that
+   * may take in the stages of the prior unit, or of `ThreadJoin` with threads.
    * */
   auto _buildUnit() {
+    if (this->prllProps().nThreads > 1) {
+      auto obj = _buildThreads();
+      DumpExpr<MapBuilder, O>::_postBuild(obj);
+      return obj;
+    }
+    auto pre = _prev;
     _prev = PrllExpr<MapBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
-    auto obj = std::make_shared<Map<meta::MapTypes<I, S, F, O>>>(std::forward<F>(_func));
-    obj->prev(_prev, obj);
+    auto obj = fuseUnit<R>(_prev, (_prev == pre) ? _fuseLen : 0,
+                           Stage{std::forward<F>(_func)}, _builtLen);
     DumpExpr<MapBuilder, O>::_postBuild(obj);
     return obj;
   }
 
   /*!
-   * returns prev unit in the dataflow
+   * returns prev unit in the dataflow, the unit is then built without
+   * fusing it with the prev unit.
    * */
-  auto prev() { return _prev; }
+  auto prev() {
+    _fuseLen = 0;
+    return _prev;
+  }
+
+  /*!
+   * internally used by the next map or filter expression to fuse its unit
+   * with the one built, see `fuseUnit`.
+   * */
+  auto _fuseRun() const { return nextFuseRun<R, Stage>(_builtLen); }
 
   /*!
    * internally used to signal if the next unit will be the first unit in the
@@ -137,9 +160,25 @@ public:
    * */
   std::false_type _isAddFirst;
 private:
+  using Stage = MapStage<meta::MapTypes<I, S, F, O>>;
+
+  // builds a unit for each thread, see `PrllExpr::prll(threads)`.
+  auto _buildThreads() {
+    auto h = _h;
+    _prev = PrllExpr<MapBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+    _builtLen = 0;
+    return this->_threadBuild(_prev, P{}, h, std::forward<F>(_func),
+        [](auto &&f) {
+          return std::make_shared<Fused<Stage>>(
+              std::make_tuple(Stage{std::forward<decltype(f)>(f)}));
+        });
+  }
+
   F _func;
   std::shared_ptr<Source<I>> _prev;
   H _h;
+  size_t _fuseLen;
+  size_t _builtLen {0};
 };
 }
 } // namespace ezl namespace ezl::detail
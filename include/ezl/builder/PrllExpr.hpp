@@ -14,11 +14,15 @@
 
 #include <initializer_list>
 #include <memory>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include <ezl/helper/meta/slct.hpp>
 #include <ezl/helper/ProcReq.hpp>
 #include <ezl/units/MPIBridge.hpp>
+#include <ezl/units/QueueBridge.hpp>
+#include <ezl/units/ThreadBridge.hpp>
 
 namespace ezl {
 template <class T> class Source;
@@ -30,12 +34,14 @@ struct ParProps {
   llmode mode {llmode::none};
   ProcReq procReq{};
   bool ordered{false};
+  size_t nThreads{0};
 };
 
 
 /*!
  * @ingroup builder
- * For adding a `MPIBridge` unit in between prev and newly built unit.
+ * For adding a `MPIBridge` unit in between prev and newly built unit, or a
+ * `QueueBridge` with NOMPI.
  * The expression can be used by any unit builder like `MapBuilder`
  * `ReduceBuilder` etc. Internally used by builders.
  *
@@ -59,6 +65,7 @@ public:
   // set unit as inprocess or non parallel
   auto& inprocess() {
     _props.isPrll = false;
+    _props.nThreads = 0;
     return ((T *)this)->_self();
   }
 
@@ -89,6 +96,17 @@ public:
     return ((T *)this)->_self();
   }
 
+  // runs the unit on a number of threads in each of its processes, with a
+  // copy of the unit for each thread. The rows are partitioned among the
+  // threads like among the processes. It can be set along with the processes
+  // e.g. prll(4).prll(threads(2)) for four processes with two threads each.
+  // The UDF is called from the threads at the same time.
+  // @param th number of threads e.g. threads(4), threads() for all the cores.
+  auto& prll(threads th) {
+    _props.nThreads = th.count ? th.count : std::thread::hardware_concurrency();
+    return ((T *)this)->_self();
+  }
+
   // makes the unit parallel with a parallel request
   // @param lprocs process request as exact ranks in initializer_list<int>
   // @param mode optional can be task, onAll, shard or none (default).
@@ -116,7 +134,6 @@ public:
 protected:
   template <class I, class P, class H>
   auto _preBuild(std::shared_ptr<Source<I>> pre, P, H&& h, bool storeLast = false) {
-    #ifndef NOMPI
     if (_props.isPrll) {
       if (P::size == 0 && (_props.mode == llmode::none)) {
         _props.procReq.resize(1);
@@ -124,17 +141,65 @@ protected:
       bool all = false;
       if (P::size == 0 && (_props.mode & llmode::dupe)) all = true;
       if (_props.mode & llmode::task) _props.procReq.setTask();
+      #ifndef NOMPI
       auto bobj = std::make_shared<MPIBridge<I, P, H>>(
           _props.procReq, all, _props.ordered, std::forward<H>(h), _last);
+      #else
+      auto bobj = std::make_shared<QueueBridge<I, P, H>>(
+          _props.procReq, all, _props.ordered, std::forward<H>(h), _last);
+      #endif
       if(storeLast) _last = bobj.get();
       bobj->prev(pre, bobj);
       pre = bobj;
       return pre;
     }
-    #endif
     return pre;
   }
 
+  /*!
+   * For adding a `ThreadBridge` after `pre` with a unit made by `make` for
+   * each thread, if there are more than one threads for the unit.
+   * @param f UDF that is copied for each unit, a single unit is made if it
+   *          can not be copied.
+   * @param make makes a unit with the UDF.
+   * @return `ThreadJoin` that has the output of the units.
+   * */
+  template <class I, class P, class H, class F, class Make>
+  auto _threadBuild(std::shared_ptr<Source<I>> pre, P, H h, F &&f,
+                    Make make) {
+    using U = typename decltype(make(std::forward<F>(f)))::element_type;
+    using O = typename U::otype;
+    auto all = (P::size == 0 && (_props.mode & llmode::dupe));
+    auto bobj = std::make_shared<ThreadBridge<I, P, H>>(_props.nThreads, all, h);
+    bobj->prev(pre, bobj);
+    auto jobj = std::make_shared<ThreadJoin<O>>();
+    bobj->join(jobj.get());
+    _threadUnits(bobj, jobj, std::forward<F>(f), make,
+                 std::is_copy_constructible<std::decay_t<F>>{});
+    return std::shared_ptr<Source<O>>{jobj};
+  }
+
+  template <class B, class J, class F, class Make>
+  void _threadUnits(B &bobj, J &jobj, F &&f, Make &make, std::true_type) {
+    for (size_t i = 1; i < _props.nThreads; ++i) {
+      auto obj = make(f);
+      obj->prev(bobj, obj);
+      jobj->prev(obj, jobj);
+    }
+    _threadUnits(bobj, jobj, std::forward<F>(f), make, std::false_type{});
+  }
+
+  template <class B, class J, class F, class Make>
+  void _threadUnits(B &bobj, J &jobj, F &&f, Make &make, std::false_type) {
+    if (bobj->next().empty() && _props.nThreads > 1) {
+      Karta::inst().log("The UDF can not be copied for the threads, the unit "
+                        "runs on a single thread.", LogMode::warning);
+    }
+    auto obj = make(std::forward<F>(f));
+    obj->prev(bobj, obj);
+    jobj->prev(obj, jobj);
+  }
+
   ParProps _props;
   Task* _last = nullptr;
 };
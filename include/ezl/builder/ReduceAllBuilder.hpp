@@ -112,14 +112,27 @@ public:
 
   /*!
    * internally called by build
-   * @return shared_ptr of ReduceAll object.
+   * @return shared_ptr of ReduceAll object, or of `ThreadJoin` with threads.
    * */
   auto _buildUnit() {
-    _prev = PrllExpr<ReduceAllBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+    using U = ReduceAll<meta::ReduceAllTypes<I, P, S, F, O>>;
     auto ordered = this->getOrdered();
-    auto obj = std::make_shared<ReduceAll<meta::ReduceAllTypes<I, P, S, F, O>>>(
-        std::forward<F>(_func), ordered, _adjacent, _fixed, _bunchSize);
-    obj->prev(_prev, obj);
+    std::shared_ptr<Source<typename U::otype>> obj;
+    if (this->prllProps().nThreads > 1) {
+      auto h = _h;
+      _prev = PrllExpr<ReduceAllBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+      obj = this->_threadBuild(_prev, P{}, h, std::forward<F>(_func),
+          [this, ordered](auto &&f) {
+            return std::make_shared<U>(std::forward<decltype(f)>(f), ordered,
+                                       _adjacent, _fixed, _bunchSize);
+          });
+    } else {
+      _prev = PrllExpr<ReduceAllBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+      auto unit = std::make_shared<U>(std::forward<F>(_func), ordered,
+                                      _adjacent, _fixed, _bunchSize);
+      unit->prev(_prev, unit);
+      obj = unit;
+    }
     DumpExpr<ReduceAllBuilder, O>::_postBuild(obj);
     return obj;
   }
@@ -87,15 +87,27 @@ public:
 
   /*!
    * internally called by build
-   * @return shared_ptr of Reduce object.
+   * @return shared_ptr of Reduce object, or of `ThreadJoin` with threads.
    * */
   auto _buildUnit() {
-    _prev = PrllExpr<ReduceBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+    using U = Reduce<meta::ReduceTypes<I, P, S, F, FO, O>>;
     auto ordered = this->getOrdered();
-    auto obj =
-        std::make_shared<Reduce<meta::ReduceTypes<I, P, S, F, FO, O>>>(
-            std::forward<F>(_func), std::forward<FO>(_initVal), _scan, ordered);
-    obj->prev(_prev, obj);
+    std::shared_ptr<Source<typename U::otype>> obj;
+    if (this->prllProps().nThreads > 1) {
+      auto h = _h;
+      _prev = PrllExpr<ReduceBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+      obj = this->_threadBuild(_prev, P{}, h, std::forward<F>(_func),
+          [this, ordered](auto &&f) {
+            return std::make_shared<U>(std::forward<decltype(f)>(f), _initVal,
+                                       _scan, ordered);
+          });
+    } else {
+      _prev = PrllExpr<ReduceBuilder>::_preBuild(_prev, P{}, std::forward<H>(_h));
+      auto unit = std::make_shared<U>(std::forward<F>(_func),
+                                      std::forward<FO>(_initVal), _scan, ordered);
+      unit->prev(_prev, unit);
+      obj = unit;
+    }
     DumpExpr<ReduceBuilder, O>::_postBuild(obj);
     return obj;
   }
@@ -0,0 +1,125 @@
+/*!
+ * @file
+ * class AsyncWriter, writing text buffers to a stream on a thread.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef ASYNCWRITER_EZL_H
+#define ASYNCWRITER_EZL_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ezl/helper/TextBuffer.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Writes the full buffers handed to it on a thread of its own, so that the
+ * thread formatting the rows does not wait for the file system. At most
+ * `depth` buffers are kept waiting, a `write` with more waits for the thread
+ * to take one. The written buffers are given back to the writer for reuse.
+ *
+ * The thread is started on the first write and is joined by `finish`, which
+ * is to be called before anything else is written to the stream.
+ *
+ * Example usage:
+ * @code
+ * AsyncWriter w;
+ * TextBuffer buf;
+ * // fill buf
+ * w.write(os, buf);  // buf is an empty buffer after this
+ * w.finish();
+ * @endcode
+ * */
+class AsyncWriter {
+public:
+  explicit AsyncWriter(size_t depth = 4) : _depth{depth ? depth : 1} {}
+  AsyncWriter(const AsyncWriter&) = delete;
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+  ~AsyncWriter() { finish(); }
+
+  /*!
+   * hands the bytes of `buf` to be written to `os` and gives back an empty
+   * buffer in `buf`.
+   * */
+  void write(std::ostream& os, TextBuffer& buf) {
+    std::unique_lock<std::mutex> lock{_mut};
+    if (!_thread.joinable()) {
+      _stop = false;
+      _thread = std::thread([this]() { _run(); });
+    }
+    _pushCv.wait(lock, [this] { return _full.size() < _depth; });
+    _full.emplace_back(&os, std::move(buf));
+    if (_free.empty()) {
+      buf = TextBuffer{};
+    } else {
+      buf = std::move(_free.back());
+      _free.pop_back();
+    }
+    lock.unlock();
+    _popCv.notify_one();
+  }
+
+  /*!
+   * waits for the buffers to be written and the thread to end.
+   * @return false if a write to the stream failed.
+   * */
+  bool finish() {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      _stop = true;
+    }
+    _popCv.notify_one();
+    if (_thread.joinable()) _thread.join();
+    auto isOk = !_isFailed;
+    _isFailed = false;
+    return isOk;
+  }
+
+private:
+  void _run() {
+    std::unique_lock<std::mutex> lock{_mut};
+    while (true) {
+      _popCv.wait(lock, [this] { return _stop || !_full.empty(); });
+      if (_full.empty()) return;
+      auto item = std::move(_full.front());
+      _full.pop_front();
+      lock.unlock();
+      _pushCv.notify_one();
+      item.first->write(item.second.data(), item.second.size());
+      auto isFailed = !*item.first;
+      item.second.clear();
+      lock.lock();
+      _isFailed = _isFailed || isFailed;
+      _free.push_back(std::move(item.second));
+    }
+  }
+
+  size_t _depth;
+  std::deque<std::pair<std::ostream*, TextBuffer>> _full;
+  std::vector<TextBuffer> _free;
+  std::thread _thread;
+  std::mutex _mut;
+  std::condition_variable _popCv;
+  std::condition_variable _pushCv;
+  bool _stop{false};
+  bool _isFailed{false};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !ASYNCWRITER_EZL_H
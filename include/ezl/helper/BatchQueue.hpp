@@ -0,0 +1,186 @@
+/*!
+ * @file
+ * class BatchQueue, batches of items produced by worker threads.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef BATCHQUEUE_EZL_H
+#define BATCHQUEUE_EZL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ezl/helper/Karta.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Runs a work function for each of the chunks of work on a number of threads
+ * and hands the batches that the work pushes to a single consumer.
+ *
+ * Chunks are taken by the threads in order. Each chunk keeps at most `depth`
+ * batches that are not popped yet, a thread pushing more waits for the
+ * consumer. If ordered, the batches are popped in the order of the chunks
+ * and in the order of pushing within a chunk, else whichever is ready.
+ * Since the lowest unfinished chunk always has a thread working on it, the
+ * bound does not deadlock the ordered consumer.
+ *
+ * An exception thrown by the work is rethrown from pop. The threads work for
+ * the rank that starts them (see `Karta::actAs`).
+ *
+ * Example usage:
+ * @code
+ * BatchQueue<int> bq;
+ * bq.start(nChunks, nThreads, true, 4, [](size_t chunk, auto& push) {
+ *   std::vector<int> batch;
+ *   // fill batch for the chunk
+ *   return push(std::move(batch));  // false if stopped, can return then
+ * });
+ * std::vector<int> batch;
+ * while (bq.pop(batch)) { ... }
+ * @endcode
+ * */
+template <class T>
+class BatchQueue {
+public:
+  using Batch = std::vector<T>;
+
+  BatchQueue() = default;
+  BatchQueue(const BatchQueue&) = delete;
+  BatchQueue& operator=(const BatchQueue&) = delete;
+  ~BatchQueue() { stop(); }
+
+  template <class F>
+  void start(size_t nChunks, size_t nThreads, bool ordered, size_t depth,
+             F work) {
+    stop();
+    _slots.assign(nChunks, Slot{});
+    _front = 0;
+    _claimed = 0;
+    _ordered = ordered;
+    _depth = depth ? depth : 1;
+    _stop = false;
+    _error = nullptr;
+    if (nThreads > nChunks) nThreads = nChunks;
+    auto rank = Karta::rankOf();
+    for (size_t i = 0; i < nThreads; ++i) {
+      _threads.emplace_back([this, work, rank]() {
+        Karta::actAs(rank);
+        _run(work);
+      });
+    }
+  }
+
+  /*!
+   * waits for the next batch.
+   * @return false if all the chunks are done and popped.
+   * */
+  bool pop(Batch& batch) {
+    std::unique_lock<std::mutex> lock{_mut};
+    while (true) {
+      if (_error) {
+        auto err = _error;
+        _error = nullptr;
+        std::rethrow_exception(err);
+      }
+      while (_front < _slots.size() && _slots[_front].done &&
+             _slots[_front].q.empty()) {
+        ++_front;
+      }
+      if (_front == _slots.size()) return false;
+      auto last = _ordered ? _front + 1 : _claimed;
+      for (auto i = _front; i < last; ++i) {
+        auto& q = _slots[i].q;
+        if (!q.empty()) {
+          batch = std::move(q.front());
+          q.pop_front();
+          _pushCv.notify_all();
+          return true;
+        }
+      }
+      _popCv.wait(lock);
+    }
+  }
+
+  // cancels the remaining work and waits for the threads.
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      _stop = true;
+    }
+    _pushCv.notify_all();
+    for (auto& it : _threads) it.join();
+    _threads.clear();
+    _slots.clear();
+  }
+
+private:
+  struct Slot {
+    std::deque<Batch> q;
+    bool done{false};
+  };
+
+  template <class F>
+  void _run(F& work) {
+    while (true) {
+      size_t chunk;
+      {
+        std::lock_guard<std::mutex> lock{_mut};
+        if (_stop || _claimed == _slots.size()) return;
+        chunk = _claimed++;
+      }
+      auto push = [this, chunk](Batch&& batch) { return _push(chunk, batch); };
+      try {
+        work(chunk, push);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock{_mut};
+        if (!_error) _error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock{_mut};
+        _slots[chunk].done = true;
+      }
+      _popCv.notify_one();
+    }
+  }
+
+  bool _push(size_t chunk, Batch& batch) {
+    {
+      std::unique_lock<std::mutex> lock{_mut};
+      auto& q = _slots[chunk].q;
+      _pushCv.wait(lock, [this, &q] { return _stop || q.size() < _depth; });
+      if (_stop) return false;
+      q.push_back(std::move(batch));
+    }
+    _popCv.notify_one();
+    return true;
+  }
+
+  std::vector<Slot> _slots;
+  std::vector<std::thread> _threads;
+  std::mutex _mut;
+  std::condition_variable _popCv;
+  std::condition_variable _pushCv;
+  std::exception_ptr _error{nullptr};
+  size_t _front{0};
+  size_t _claimed{0};
+  size_t _depth{1};
+  bool _ordered{true};
+  bool _stop{false};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !BATCHQUEUE_EZL_H
@@ -0,0 +1,270 @@
+/*!
+ * @file
+ * class BinaryColumns, typed columnar blocks of rows for the binary format.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef BINARYCOLUMNS_EZL_H
+#define BINARYCOLUMNS_EZL_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Type code and size of a column in the schema and its encoding. A column of
+ * trivially copyable type (numbers, chars, std::array of numbers etc.) is
+ * kept as the bytes of the values, the code tells integer, unsigned, real
+ * or raw bytes.
+ * */
+template <class T, class Enable = void>
+struct BinaryCol {
+  static constexpr bool supported = std::is_trivially_copyable<T>::value;
+  static constexpr char code =
+      std::is_floating_point<T>::value
+          ? 'f'
+          : (std::is_integral<T>::value ? (std::is_signed<T>::value ? 'i' : 'u')
+                                        : 'r');
+  static constexpr uint32_t size = sizeof(T);
+
+  static void put(std::vector<char>& data, std::vector<uint32_t>&,
+                  const T& val) {
+    auto p = (const char*)&val;
+    data.insert(data.end(), p, p + sizeof(T));
+  }
+
+  // reads the value at the cursor and moves it to the next.
+  static void get(const char*& data, const char*&, T& val) {
+    std::memcpy((void*)&val, data, sizeof(T));
+    data += sizeof(T);
+  }
+};
+
+// a string column has the lengths of the strings followed by the characters.
+template <>
+struct BinaryCol<std::string> {
+  static constexpr bool supported = true;
+  static constexpr char code = 's';
+  static constexpr uint32_t size = 0;
+
+  static void put(std::vector<char>& data, std::vector<uint32_t>& lens,
+                  const std::string& val) {
+    lens.push_back(uint32_t(val.size()));
+    data.insert(data.end(), val.begin(), val.end());
+  }
+
+  static void get(const char*& data, const char*& lens, std::string& val) {
+    uint32_t n;
+    std::memcpy(&n, lens, sizeof(n));
+    lens += sizeof(n);
+    val.assign(data, n);
+    data += n;
+  }
+};
+
+// the row type with the references and const of the columns removed.
+// `supported` if all the columns can be kept in the binary format.
+template <class T> struct BinaryRow;
+template <class... Ts> struct BinaryRow<std::tuple<Ts...>> {
+  using type = std::tuple<std::decay_t<Ts>...>;
+  static constexpr bool supported = std::is_same<
+      std::integer_sequence<bool, true, BinaryCol<std::decay_t<Ts>>::supported...>,
+      std::integer_sequence<bool, BinaryCol<std::decay_t<Ts>>::supported..., true>>::value;
+};
+
+template <class T> class BinaryColumns;
+
+/*!
+ * @ingroup helper
+ * Encodes rows in blocks with the values of each column together and
+ * decodes the blocks back to rows without any parsing.
+ *
+ * A file has a header with the schema derived from the row type, i.e. a
+ * type code and size for each column, followed by the blocks. A block has a
+ * marker, the number of rows and the size of the columns in bytes, so that
+ * the blocks can be skipped without reading the columns. The numbers are in
+ * the byte order of the host.
+ *
+ * Example usage:
+ * @code
+ * BinaryColumns<std::tuple<int, std::string>> bc;
+ * os << BinaryColumns<...>::header();
+ * bc.add(row);
+ * bc.write(os);  // writes the rows added as a block
+ *
+ * uint32_t n;
+ * auto next = BinaryColumns<...>::blockEnd(it, last, n);
+ * if (next && bc.read(it, next)) {
+ *   for (auto i = 0U; i < n; ++i) bc.get(row);
+ * }
+ * @endcode
+ * */
+template <class... Ts>
+class BinaryColumns<std::tuple<Ts...>> {
+public:
+  static constexpr size_t nCols = sizeof...(Ts);
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t marker = 0x4b4c4245;  // "EBLK"
+  static constexpr size_t headerSize = 12 + 5 * nCols;
+  static constexpr size_t blockHeaderSize = 16;
+
+  // file header with the schema of the columns.
+  static std::string header() {
+    std::string h{"EZLB"};
+    _append(h, version);
+    _append(h, uint32_t(nCols));
+    std::array<char, nCols> codes{{BinaryCol<Ts>::code...}};
+    std::array<uint32_t, nCols> sizes{{BinaryCol<Ts>::size...}};
+    for (size_t i = 0; i < nCols; ++i) {
+      h += codes[i];
+      _append(h, sizes[i]);
+    }
+    return h;
+  }
+
+  // if [first, last) begins with the same header.
+  static bool isHeader(const char* first, const char* last) {
+    auto h = header();
+    return size_t(last - first) >= h.size() &&
+           std::equal(h.begin(), h.end(), first);
+  }
+
+  /*!
+   * reads the header of the block at `it`.
+   * @return end of the block, nullptr if it is not a complete block.
+   * */
+  static const char* blockEnd(const char* it, const char* last,
+                              uint32_t& nRows) {
+    if (size_t(last - it) < blockHeaderSize) return nullptr;
+    uint32_t mark;
+    uint64_t bytes;
+    std::memcpy(&mark, it, 4);
+    std::memcpy(&nRows, it + 4, 4);
+    std::memcpy(&bytes, it + 8, 8);
+    if (mark != marker || bytes > uint64_t(last - it - blockHeaderSize)) {
+      return nullptr;
+    }
+    return it + blockHeaderSize + bytes;
+  }
+
+  template <class Row>
+  void add(const Row& row) {
+    _add(row, std::index_sequence_for<Ts...>{});
+    ++_nRows;
+  }
+
+  size_t rows() const { return _nRows; }
+
+  size_t bytes() const {
+    size_t n = 0;
+    for (size_t i = 0; i < nCols; ++i) {
+      n += _data[i].size() + _lens[i].size() * sizeof(uint32_t);
+    }
+    return n;
+  }
+
+  // writes the rows added as a block and clears them.
+  void write(std::ostream& os) {
+    if (!_nRows) return;
+    std::string h;
+    _append(h, marker);
+    _append(h, uint32_t(_nRows));
+    _append(h, uint64_t(bytes()));
+    os.write(h.data(), h.size());
+    for (size_t i = 0; i < nCols; ++i) {
+      os.write((const char*)_lens[i].data(), _lens[i].size() * sizeof(uint32_t));
+      os.write(_data[i].data(), _data[i].size());
+      _lens[i].clear();
+      _data[i].clear();
+    }
+    _nRows = 0;
+  }
+
+  /*!
+   * sets the cursors of the columns to the beginning of the block at `it`
+   * that ends at `last` (see `blockEnd`).
+   * @return false if the columns of the rows do not fill the block exactly.
+   * */
+  bool read(const char* it, const char* last) {
+    uint32_t nRows;
+    std::memcpy(&nRows, it + 4, 4);
+    it += blockHeaderSize;
+    std::array<uint32_t, nCols> sizes{{BinaryCol<Ts>::size...}};
+    for (size_t i = 0; i < nCols; ++i) {
+      if (sizes[i]) {
+        auto n = uint64_t(nRows) * sizes[i];
+        if (n > uint64_t(last - it)) return false;
+        _lenCur[i] = nullptr;
+        _dataCur[i] = it;
+        it += n;
+        continue;
+      }
+      if (uint64_t(nRows) * sizeof(uint32_t) > uint64_t(last - it)) {
+        return false;
+      }
+      _lenCur[i] = it;
+      uint64_t total = 0;
+      for (uint32_t r = 0; r < nRows; ++r, it += sizeof(uint32_t)) {
+        uint32_t n;
+        std::memcpy(&n, it, sizeof(n));
+        total += n;
+      }
+      if (total > uint64_t(last - it)) return false;
+      _dataCur[i] = it;
+      it += total;
+    }
+    return it == last;
+  }
+
+  // next row of the block read.
+  void get(std::tuple<Ts...>& row) {
+    _get(row, std::index_sequence_for<Ts...>{});
+  }
+
+private:
+  template <class T>
+  static void _append(std::string& s, T val) {
+    s.append((const char*)&val, sizeof(T));
+  }
+
+  template <class Row, size_t... is>
+  void _add(const Row& row, std::index_sequence<is...>) {
+    using swallow = int[];
+    (void)swallow{0, (BinaryCol<Ts>::put(_data[is], _lens[is],
+                                         std::get<is>(row)), 0)...};
+  }
+
+  template <size_t... is>
+  void _get(std::tuple<Ts...>& row, std::index_sequence<is...>) {
+    using swallow = int[];
+    (void)swallow{0, (BinaryCol<Ts>::get(_dataCur[is], _lenCur[is],
+                                         std::get<is>(row)), 0)...};
+  }
+
+  size_t _nRows{0};
+  std::array<std::vector<char>, nCols> _data;
+  std::array<std::vector<uint32_t>, nCols> _lens;
+  std::array<const char*, nCols> _dataCur;
+  std::array<const char*, nCols> _lenCur;
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !BINARYCOLUMNS_EZL_H
@@ -0,0 +1,231 @@
+/*!
+ * @file
+ * class ChunkQueue, for the processes of a unit to take chunks of work on
+ * demand.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef CHUNKQUEUE_EZL_H
+#define CHUNKQUEUE_EZL_H
+
+#include <algorithm>
+#include <vector>
+
+#ifndef NOMPI
+#include <boost/mpi.hpp>
+#endif
+
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/rootShare.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Chunks of work that the processes of a unit take one at a time as they
+ * get done with the prior, rather than each taking a fixed share in the
+ * beginning. The process at first position of `procs` keeps the count of
+ * the chunks given and replies to the requests of the rest in between its
+ * own work, whenever it takes a chunk or calls `poll`. The rest ask for a
+ * chunk as they start the prior one, to not wait for the reply.
+ *
+ * Like `rootShare` it is to be used by all the processes in `procs`, and
+ * if `procs` are not the ranks of the running processes, e.g. with NOMPI,
+ * a process takes every n-th chunk from its position for n processes.
+ *
+ * Example usage:
+ * @code
+ * ChunkQueue q;
+ * q.reset(pos, procs, 1000, 10);  // 100 chunks of 10 items
+ * size_t first, last;
+ * while (q.next(first, last)) {
+ *   for (auto i = first; i < last; ++i) { q.poll(); work(i); }
+ * }
+ * @endcode
+ * */
+class ChunkQueue {
+public:
+  // number of chunks for each process if the size of chunk is not given.
+  static constexpr size_t chunksPerProc = 16;
+  // calls to poll after which the first process replies to the requests.
+  static constexpr size_t pollCalls = 64;
+
+  /*!
+   * divides `len` items in chunks of `size` or in `chunksPerProc` chunks for
+   * each process if `size` is zero.
+   * */
+  void reset(int pos, const std::vector<int>& procs, size_t len,
+             size_t size = 0) {
+    _len = len;
+    _pos = pos;
+    _nProc = std::max(int(procs.size()), 1);
+    _size = size ? size : std::max(len / (_nProc * chunksPerProc), size_t(1));
+    _count = (len + _size - 1) / _size;
+    _given = _nProc;
+    _taken = 0;
+    _polls = 0;
+    _isDone = false;
+    _procs = procs;
+    _done.assign(_nProc, false);
+    _isRanks = false;
+#ifndef NOMPI
+    const auto& comm = Karta::inst().comm();
+    _isRanks = _nProc > 1 && pos >= 0 && pos < _nProc &&
+               procs[pos] == comm.rank() &&
+               std::all_of(std::begin(procs), std::end(procs),
+                           [&comm](int r) { return r < comm.size(); });
+#endif
+  }
+
+  // number of chunks.
+  size_t count() const { return _count; }
+
+  /*!
+   * index of the next chunk of the process in `chunk`.
+   * @return false if no chunk is left.
+   * */
+  bool next(size_t& chunk) {
+    if (_isDone) return false;
+    auto isFirst = (_taken++ == 0);
+    if (!_isRanks) {
+      chunk = _pos + (_taken - 1) * _nProc;
+      _isDone = (chunk >= _count);
+      return !_isDone;
+    }
+#ifndef NOMPI
+    if (_pos == 0) {
+      _serve();
+      if (isFirst && _count) {
+        chunk = 0;
+        return true;
+      }
+      if (_given < _count) {
+        chunk = _given++;
+        return true;
+      }
+      _finish();
+      _isDone = true;
+      return false;
+    }
+    if (isFirst && size_t(_pos) < _count) {
+      chunk = _pos;
+      _request();
+      return true;
+    }
+    if (isFirst) _request();
+    _recvReq.wait();
+    _sendReq.wait();
+    if (_reply < 0) {
+      _isDone = true;
+      return false;
+    }
+    chunk = _reply;
+    _request();
+    return true;
+#else
+    (void)isFirst;
+    return false;
+#endif
+  }
+
+  /*!
+   * items [first, last) of the next chunk of the process.
+   * @return false if no chunk is left.
+   * */
+  bool next(size_t& first, size_t& last) {
+    size_t chunk;
+    if (!next(chunk)) return false;
+    first = chunk * _size;
+    last = std::min(first + _size, _len);
+    return true;
+  }
+
+  /*!
+   * to be called often while working on a chunk, e.g. for every row, so that
+   * the first process replies to the requests in time. A call for a batch
+   * of rows counts as `n` calls, so the first process replies as often as
+   * when it is called for each row of the batch.
+   * */
+  void poll(size_t n = 1) {
+#ifndef NOMPI
+    if (!_isRanks || _pos != 0) return;
+    _polls += n;
+    if (_polls >= pollCalls) {
+      _polls %= pollCalls;
+      _serve();
+    }
+#else
+    (void)n;
+#endif
+  }
+
+  /*!
+   * takes the chunks left without working on them, for a process that stops
+   * early e.g. on reaching a limit of rows, so that the rest are not kept
+   * waiting.
+   * */
+  void finish() {
+    size_t chunk;
+    while (next(chunk));
+  }
+
+private:
+#ifndef NOMPI
+  void _request() {
+    const auto& comm = Karta::inst().comm();
+    _sendReq = comm.isend(_procs[0], riseTag, _pos);
+    _recvReq = comm.irecv(_procs[0], riseTag, _reply);
+  }
+
+  // the requests are received only from the processes not done, hence
+  // the requests of a process for a later unit are left for it.
+  void _serve() {
+    const auto& comm = Karta::inst().comm();
+    for (int i = 1; i < _nProc; ++i) {
+      if (!_done[i] && comm.iprobe(_procs[i], riseTag)) _answer(i);
+    }
+  }
+
+  void _finish() {
+    for (int i = 1; i < _nProc; ++i) {
+      if (!_done[i]) _answer(i);
+    }
+  }
+
+  void _answer(int i) {
+    const auto& comm = Karta::inst().comm();
+    int from;
+    comm.recv(_procs[i], riseTag, from);
+    long long chunk = (_given < _count) ? (long long)(_given++) : -1LL;
+    if (chunk < 0) _done[i] = true;
+    comm.send(_procs[i], riseTag, chunk);
+  }
+
+  boost::mpi::request _sendReq;
+  boost::mpi::request _recvReq;
+#endif
+  size_t _len{0};
+  int _pos{0};
+  int _nProc{1};
+  size_t _size{1};
+  size_t _count{0};
+  size_t _given{0};
+  size_t _taken{0};
+  size_t _polls{0};
+  bool _isDone{false};
+  bool _isRanks{false};
+  long long _reply{-1};
+  std::vector<int> _procs;
+  std::vector<bool> _done;
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !CHUNKQUEUE_EZL_H
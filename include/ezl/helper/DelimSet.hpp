@@ -0,0 +1,184 @@
+/*!
+ * @file
+ * class DelimSet, vectorized search for delimiter characters.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef DELIMSET_EZL_H
+#define DELIMSET_EZL_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#if !defined NOSIMD && defined __AVX2__
+#define EZL_SIMD_WIDTH 32
+#include <immintrin.h>
+#elif !defined NOSIMD && defined __SSE2__
+#define EZL_SIMD_WIDTH 16
+#include <emmintrin.h>
+#endif
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * A set of delimiter characters for splitting rows and columns.
+ *
+ * With SSE2 (default on x86-64) a block of 16 bytes is compared against each
+ * delimiter at once, with AVX2 (e.g. `-mavx2` or `-march=native`) a block of
+ * 32 bytes. The result is a bit mask of delimiter positions in the block
+ * and tokens are found from the transitions in the mask, so a block with
+ * many short columns is scanned only once. The scalar fallback uses a lookup
+ * table, it is used when SIMD is not available, disabled with `-DNOSIMD`, for
+ * sets of more than `maxSimd` characters and for the tail of a buffer.
+ *
+ * Example usage:
+ * @code
+ * DelimSet ds{" \t"};
+ * ds.tokens(first, last, [](const char* b, const char* e) {
+ *   // b, e is a column
+ *   return true;  // false to stop scanning the rest
+ * });
+ * @endcode
+ * */
+class DelimSet {
+public:
+  static constexpr size_t maxSimd = 8;
+
+  DelimSet() { reset(""); }
+
+  explicit DelimSet(const std::string& chars) { reset(chars); }
+
+  void reset(const std::string& chars) {
+    _table.fill(false);
+    _n = 0;
+    for (auto c : chars) {
+      if (_table[(unsigned char)c]) continue;
+      _table[(unsigned char)c] = true;
+      if (_n < maxSimd) _chars[_n] = c;
+      ++_n;
+    }
+  }
+
+  bool empty() const { return _n == 0; }
+
+  bool has(char c) const { return _table[(unsigned char)c]; }
+
+  /*!
+   * @return first delimiter in [first, last) or last.
+   * */
+  const char* find(const char* first, const char* last) const {
+    return _scan<true>(first, last);
+  }
+
+  /*!
+   * @return first non delimiter in [first, last) or last.
+   * */
+  const char* skip(const char* first, const char* last) const {
+    return _scan<false>(first, last);
+  }
+
+  /*!
+   * calls `f(begin, end)` for each token in [first, last) separated by one or
+   * more delimiters, i.e. same as boost::split with token compression but
+   * without the empty tokens at the ends. Stops if `f` returns false.
+   * */
+  template <class F>
+  void tokens(const char* first, const char* last, F&& f) const {
+    auto it = first;
+    auto inTok = false;
+    const char* tokBegin = first;
+#ifdef EZL_SIMD_WIDTH
+    if (_n <= maxSimd) {
+      while (last - it >= EZL_SIMD_WIDTH) {
+        auto d = _mask(it);
+        auto nd = ~d & _full;
+        auto preNd = ((nd << 1) | uint32_t(inTok)) & _full;
+        auto edges = (nd & ~preNd) | (d & preNd);
+        while (edges) {
+          auto pos = it + __builtin_ctz(edges);
+          if (inTok) {
+            if (!f(tokBegin, pos)) return;
+          } else {
+            tokBegin = pos;
+          }
+          inTok = !inTok;
+          edges &= edges - 1;
+        }
+        it += EZL_SIMD_WIDTH;
+      }
+    }
+#endif
+    for (; it != last; ++it) {
+      if (_table[(unsigned char)*it] == inTok) {
+        if (inTok) {
+          if (!f(tokBegin, it)) return;
+        } else {
+          tokBegin = it;
+        }
+        inTok = !inTok;
+      }
+    }
+    if (inTok) f(tokBegin, last);
+  }
+
+private:
+  template <bool isDelim>
+  const char* _scan(const char* it, const char* last) const {
+#ifdef EZL_SIMD_WIDTH
+    if (_n <= maxSimd) {
+      while (last - it >= EZL_SIMD_WIDTH) {
+        auto d = _mask(it);
+        if (!isDelim) d = ~d & _full;
+        if (d) return it + __builtin_ctz(d);
+        it += EZL_SIMD_WIDTH;
+      }
+    }
+#endif
+    for (; it != last; ++it) {
+      if (_table[(unsigned char)*it] == isDelim) return it;
+    }
+    return last;
+  }
+
+#ifdef EZL_SIMD_WIDTH
+  // bit i is set if it[i] is a delimiter.
+  uint32_t _mask(const char* it) const {
+#if EZL_SIMD_WIDTH == 32
+    auto block = _mm256_loadu_si256((const __m256i*)it);
+    auto acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < _n; ++i) {
+      acc = _mm256_or_si256(acc,
+          _mm256_cmpeq_epi8(block, _mm256_set1_epi8(_chars[i])));
+    }
+    return uint32_t(_mm256_movemask_epi8(acc));
+#else
+    auto block = _mm_loadu_si128((const __m128i*)it);
+    auto acc = _mm_setzero_si128();
+    for (size_t i = 0; i < _n; ++i) {
+      acc = _mm_or_si128(acc, _mm_cmpeq_epi8(block, _mm_set1_epi8(_chars[i])));
+    }
+    return uint32_t(_mm_movemask_epi8(acc));
+#endif
+  }
+
+  static constexpr uint32_t _full =
+      (EZL_SIMD_WIDTH == 32) ? 0xFFFFFFFFu : ((1u << EZL_SIMD_WIDTH) - 1);
+#endif
+
+  std::array<bool, 256> _table;
+  std::array<char, maxSimd> _chars{};
+  size_t _n{0};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !DELIMSET_EZL_H
@@ -0,0 +1,335 @@
+/*!
+ * @file
+ * class GzStreamBuf, stream buffer decompressing gzip files with zlib.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef GZSTREAMBUF_EZL_H
+#define GZSTREAMBUF_EZL_H
+
+#include <algorithm>
+#include <cstring>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Input stream buffer that decompresses a gzip file while reading.
+ *
+ * A plain gzip file (including concatenated members) is read as a stream
+ * and can not be seeked, hence it is read as a whole by a process. A blocked
+ * gzip file (BGZF, as written by `bgzip`) is a series of gzip members of
+ * at most 64KB each with the block size in the header. It is read a block at
+ * a time and can be seeked to a block using the `.gzi` index next to it, as
+ * written by `bgzip -i`, or else by a forward scan of the block headers.
+ *
+ * The positions of a blocked file are in terms of the compressed bytes so
+ * that the files are shared between processes by their size on disk like
+ * the plain files. A position inside a block is the block offset plus the
+ * uncompressed offset scaled to the compressed size of the block, rounded
+ * up. Seeking to a position gives the last uncompressed byte with position
+ * not more than it, which keeps the rows that begin before the share of a
+ * process with the prior process as for the plain files.
+ *
+ * Example usage:
+ * @code
+ * GzStreamBuf gz;
+ * if (gz.open("dump.txt.gz")) {
+ *   std::istream in(&gz);
+ *   in.seekg(offset);
+ *   std::getline(in, line);
+ * }
+ * @endcode
+ * */
+class GzStreamBuf : public std::streambuf {
+public:
+  enum class Format { plain, gzip, bgzf };
+
+  GzStreamBuf() = default;
+  GzStreamBuf(const GzStreamBuf&) = delete;
+  GzStreamBuf& operator=(const GzStreamBuf&) = delete;
+  ~GzStreamBuf() { close(); }
+
+  // format of the file from the magic bytes and header.
+  static Format detect(const std::string& fname) {
+    auto fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd == -1) return Format::plain;
+    unsigned char h[headerSize];
+    auto n = ::pread(fd, h, headerSize, 0);
+    ::close(fd);
+    return _format(h, n);
+  }
+
+  bool open(const std::string& fname) {
+    close();
+    _fd = ::open(fname.c_str(), O_RDONLY);
+    if (_fd == -1) return false;
+    struct stat st;
+    if (::fstat(_fd, &st) == -1) {
+      close();
+      return false;
+    }
+    _size = st.st_size;
+    unsigned char h[headerSize];
+    _fmt = _format(h, ::pread(_fd, h, headerSize, 0));
+    std::memset(&_zs, 0, sizeof(_zs));
+    if (inflateInit2(&_zs, 16 + MAX_WBITS) != Z_OK) {
+      close();
+      return false;
+    }
+    _zInit = true;
+    _in.resize(inSize);
+    _rewind();
+    _blocks.clear();
+    if (isBlocked()) _loadIndex(fname + ".gzi");
+    return true;
+  }
+
+  bool is_open() const { return _fd != -1; }
+
+  bool isBlocked() const { return _fmt == Format::bgzf; }
+
+  void close() {
+    if (_zInit) inflateEnd(&_zs);
+    _zInit = false;
+    if (_fd != -1) ::close(_fd);
+    _fd = -1;
+    setg(nullptr, nullptr, nullptr);
+  }
+
+protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    auto more = isBlocked() ? _nextBlock() : _inflateMore();
+    if (!more) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    if (dir == std::ios_base::cur && off == 0) return _tell();
+    if (dir == std::ios_base::beg) return seekpos(off, which);
+    return pos_type(off_type(-1));
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode) override {
+    auto target = (long long)(off_type(pos));
+    if (!is_open() || target < 0) return pos_type(off_type(-1));
+    if (!isBlocked()) {
+      if (target == _tell()) return pos;
+      if (target != 0) return pos_type(off_type(-1));
+      _rewind();
+      return pos;
+    }
+    auto off = _blockOf(target);
+    if (off >= _size || !_loadBlock(off)) {
+      _coff = _size;
+      _csize = 0;
+      setg(_out.data(), _out.data(), _out.data());
+      return pos;
+    }
+    auto usize = (long long)(egptr() - eback());
+    auto u = usize ? (target - _coff) * usize / _csize : 0;
+    setg(eback(), eback() + std::min(u, usize), egptr());
+    return pos;
+  }
+
+private:
+  static constexpr size_t headerSize = 18;
+  static constexpr size_t inSize = 1 << 16;
+  static constexpr size_t scanSize = 1 << 20;
+
+  static Format _format(const unsigned char* h, ssize_t n) {
+    if (n < 10 || h[0] != 0x1f || h[1] != 0x8b) return Format::plain;
+    if (n == ssize_t(headerSize) && (h[3] & 4) && h[12] == 'B' &&
+        h[13] == 'C' && h[14] == 2 && h[15] == 0) {
+      return Format::bgzf;
+    }
+    return Format::gzip;
+  }
+
+  void _rewind() {
+    _coff = 0;
+    _csize = 0;
+    _ubase = 0;
+    inflateReset(&_zs);
+    _zs.avail_in = 0;
+    _inPos = 0;
+    setg(_out.data(), _out.data(), _out.data());
+  }
+
+  long long _tell() const {
+    auto u = (long long)(gptr() - eback());
+    if (!isBlocked()) return _ubase + u;
+    auto usize = (long long)(egptr() - eback());
+    if (!usize) return _coff + _csize;
+    return _coff + (u * _csize + usize - 1) / usize;
+  }
+
+  // compressed size of the block at off from the BC field of its header.
+  bool _blockSize(long long off, long long& csize) const {
+    unsigned char h[headerSize];
+    if (::pread(_fd, h, headerSize, off) != ssize_t(headerSize) ||
+        _format(h, headerSize) != Format::bgzf) {
+      return false;
+    }
+    csize = (long long)(h[16] | (h[17] << 8)) + 1;
+    return true;
+  }
+
+  // offset of the block that has the compressed position `target`, or of
+  // the end if there is none. From the index if there is one, else the
+  // headers are scanned from the beginning reading `scanSize` bytes at once.
+  long long _blockOf(long long target) const {
+    if (target >= _size) return _size;
+    if (!_blocks.empty()) {
+      return *(std::upper_bound(_blocks.begin(), _blocks.end(), target) - 1);
+    }
+    std::vector<unsigned char> buf(scanSize);
+    auto off = 0LL;
+    auto bufOff = 0LL;
+    auto n = 0LL;
+    while (off < _size) {
+      if (off + (long long)headerSize > bufOff + n) {
+        bufOff = off;
+        n = ::pread(_fd, buf.data(), buf.size(), off);
+        if (n < (long long)headerSize) break;
+      }
+      const auto h = buf.data() + (off - bufOff);
+      if (_format(h, headerSize) != Format::bgzf) break;
+      auto csize = (long long)(h[16] | (h[17] << 8)) + 1;
+      if (off + csize > target) break;
+      off += csize;
+    }
+    return off;
+  }
+
+  // offsets of the blocks from the `.gzi` index, i.e. the count and the
+  // pairs of compressed and uncompressed offset of the blocks after the
+  // first, as little endian 64 bit numbers. Left empty if it is not valid.
+  void _loadIndex(const std::string& fname) {
+    auto fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd == -1) return;
+    std::vector<unsigned char> data;
+    unsigned char buf[1 << 12];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+      data.insert(data.end(), buf, buf + n);
+    }
+    ::close(fd);
+    auto num = [&data](size_t i) {
+      unsigned long long v = 0;
+      for (auto j = 0; j < 8; ++j) {
+        v |= (unsigned long long)data[i + j] << (8 * j);
+      }
+      return (long long)v;
+    };
+    if (data.size() < 8) return;
+    auto count = (size_t)num(0);
+    if (data.size() != 8 + 16 * count) return;
+    _blocks.push_back(0);
+    for (size_t i = 0; i < count; ++i) {
+      auto off = num(8 + 16 * i);
+      if (off <= _blocks.back() || off >= _size) {
+        _blocks.clear();
+        return;
+      }
+      _blocks.push_back(off);
+    }
+  }
+
+  bool _loadBlock(long long off) {
+    long long csize;
+    if (!_blockSize(off, csize)) return false;
+    _in.resize(csize);
+    if (::pread(_fd, _in.data(), csize, off) != csize) return false;
+    auto tail = (const unsigned char*)_in.data() + csize - 4;
+    size_t usize = tail[0] | (tail[1] << 8) | (tail[2] << 16) |
+                   (size_t(tail[3]) << 24);
+    _out.resize(usize ? usize : 1);
+    inflateReset(&_zs);
+    _zs.next_in = (Bytef*)_in.data();
+    _zs.avail_in = uInt(csize);
+    _zs.next_out = (Bytef*)_out.data();
+    _zs.avail_out = uInt(usize);
+    if (usize && inflate(&_zs, Z_FINISH) != Z_STREAM_END) return false;
+    _coff = off;
+    _csize = csize;
+    setg(_out.data(), _out.data(), _out.data() + usize);
+    return true;
+  }
+
+  // next block with data, the end of file block has none.
+  bool _nextBlock() {
+    auto off = _coff + _csize;
+    while (off < _size) {
+      if (!_loadBlock(off)) return false;
+      if (egptr() > eback()) return true;
+      off += _csize;
+    }
+    _coff = _size;
+    _csize = 0;
+    return false;
+  }
+
+  // inflates the stream till some output, members are read one after other.
+  bool _inflateMore() {
+    _ubase += egptr() - eback();
+    _out.resize(inSize * 4);
+    while (true) {
+      if (_zs.avail_in == 0) {
+        auto n = ::pread(_fd, _in.data(), _in.size(), _inPos);
+        if (n <= 0) return false;
+        _inPos += n;
+        _zs.next_in = (Bytef*)_in.data();
+        _zs.avail_in = uInt(n);
+      }
+      _zs.next_out = (Bytef*)_out.data();
+      _zs.avail_out = uInt(_out.size());
+      auto ret = inflate(&_zs, Z_NO_FLUSH);
+      auto produced = _out.size() - _zs.avail_out;
+      if (ret == Z_STREAM_END) {
+        inflateReset(&_zs);
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        return false;
+      }
+      if (produced) {
+        setg(_out.data(), _out.data(), _out.data() + produced);
+        return true;
+      }
+    }
+  }
+
+  int _fd{-1};
+  Format _fmt{Format::plain};
+  long long _size{0};
+  z_stream _zs;
+  bool _zInit{false};
+  std::vector<char> _in;
+  std::vector<char> _out;
+  long long _inPos{0};   // next compressed byte to read in a stream
+  long long _ubase{0};   // uncompressed bytes before the buffer in a stream
+  long long _coff{0};    // offset of the current block
+  long long _csize{0};   // compressed size of the current block
+  std::vector<long long> _blocks;  // offsets of the blocks from the index
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !GZSTREAMBUF_EZL_H
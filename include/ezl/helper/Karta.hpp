@@ -17,6 +17,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <string>
 #include <unordered_set>
 
 #include <ezl/pipeline/Task.hpp>
@@ -82,11 +83,51 @@ private:
 public:
   static constexpr auto prllRatio = 0.50;
 
+  // with NOMPI each rank run by `runRanks` is a thread with its own Karta,
+  // unless the thread works for another rank, see `actAs`.
   static Karta &inst() {
+#ifndef NOMPI
     static Karta inst;
     return inst;
+#else
+    static thread_local Karta inst;
+    return _lent() ? *_lent() : inst;
+#endif
   };
 
+#ifndef NOMPI
+  struct Rank {};
+  static Rank rankOf() { return Rank{}; }
+  static void actAs(const Rank&) {}
+#else
+  struct Rank {
+    detail::RankCtx ctx;
+    Karta *karta;
+  };
+  /*!
+   * the rank of the calling thread with its Karta, for a thread that works
+   * for the rank e.g. of a stream to take with `actAs`. With MPI the
+   * process has one Karta for all the threads and there is nothing to take.
+   * */
+  static Rank rankOf() { return Rank{detail::rankCtx(), &inst()}; }
+  static void actAs(const Rank &r) {
+    detail::rankCtx() = r.ctx;
+    _lent() = r.karta;
+  }
+#endif
+
+  // whether the flows can be run by a thread other than main, with MPI the
+  // library needs to allow it (`MPI_THREAD_SERIALIZED`, asked by `Env` if
+  // `isThreaded`).
+  bool isThreaded() const {
+#ifndef NOMPI
+    return boost::mpi::environment::thread_level() >=
+           boost::mpi::threading::serialized;
+#else
+    return true;
+#endif
+  }
+
   auto getId() { return _counter++; }
 
   const int &nProc() const { return _nProc; }
@@ -99,9 +140,10 @@ public:
     }
   }
 
-  // A rudimentary log to be extended later.
+  // A rudimentary log to be extended later. A line is written at once so
+  // that the lines of the ranks run as threads do not mix.
   void log(std::string msg, LogMode mode = LogMode::info) const {
-    if (mode & _logMode) std::cerr<<_rank<<": "<<msg<<std::endl;
+    if (mode & _logMode) std::cerr<<(std::to_string(_rank) + ": " + msg + "\n");
   }
 
   void log0(std::string msg, LogMode mode = LogMode::info) const {
@@ -109,7 +151,7 @@ public:
   }
 
   void print(std::string str) {
-    std::cout<<_rank<<": "<<str<<std::endl;
+    std::cout<<(std::to_string(_rank) + ": " + str + "\n")<<std::flush;
   }
 
   void print0(std::string str) {
@@ -182,8 +224,13 @@ public:
     auto assigned = _assign(std::vector<std::vector<Task *>>{{roots}}, curRun,
                             std::vector<std::vector<int>>{{}});
     auto temp = _assign(bridges, curRun, assigned);
-    for (auto &it : roots) it->prePull();
-    for (auto &it : roots) it->pull();
+    try {
+      for (auto &it : roots) it->prePull();
+      for (auto &it : roots) it->pull();
+    } catch (...) {
+      --_isRunning;  // the next flow is not run as a part of the failed one
+      throw;
+    }
     for (auto &it : _procs) {
       it.first[1] += it.first[2];
       it.first[0] = 0;
@@ -197,6 +244,14 @@ public:
   const auto &comm() const { return _comm.internal(); }
 
 private:
+#ifdef NOMPI
+  // Karta of the rank that the thread works for.
+  static Karta *&_lent() {
+    static thread_local Karta *karta{nullptr};
+    return karta;
+  }
+#endif
+
   // increments allocation count and sorts to get least occupied processs at
   // the top.
   void _markAlloc(std::vector<int> n) {
@@ -0,0 +1,107 @@
+/*!
+ * @file
+ * class MappedRange, read-only memory map of a file from a byte offset.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef MAPPEDRANGE_EZL_H
+#define MAPPEDRANGE_EZL_H
+
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Maps a file read-only from a byte offset till its end. The offset need not
+ * be page aligned, `begin()` points at the requested byte.
+ *
+ * Mapping is lazy, pages are read from the disk only when they are touched,
+ * so a process mapping from its share's beginning till the end of the file
+ * reads only its share and the few bytes that it reads past its end to
+ * complete the last row.
+ * */
+class MappedRange {
+public:
+  MappedRange() = default;
+  MappedRange(const MappedRange&) = delete;
+  MappedRange& operator=(const MappedRange&) = delete;
+  ~MappedRange() { close(); }
+
+  /*!
+   * map file `fname` from `offset` till end of file.
+   * @return false if file can not be opened or mapped.
+   * */
+  bool open(const std::string& fname, long long offset = 0) {
+    close();
+    auto fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      ::close(fd);
+      return false;
+    }
+    long long size = st.st_size;
+    if (offset < 0) offset = 0;
+    if (offset > size) offset = size;
+    auto page = (long long)(::sysconf(_SC_PAGESIZE));
+    auto aligned = offset - (offset % page);
+    _len = size_t(size - aligned);
+    _open = true;
+    if (_len == 0) {  // nothing to map, empty range
+      ::close(fd);
+      _begin = _end = nullptr;
+      return true;
+    }
+    _addr = ::mmap(nullptr, _len, PROT_READ, MAP_PRIVATE, fd, aligned);
+    ::close(fd);
+    if (_addr == MAP_FAILED) {
+      _addr = nullptr;
+      _open = false;
+      return false;
+    }
+    ::madvise(_addr, _len, MADV_SEQUENTIAL);
+    _begin = (const char*)_addr + (offset - aligned);
+    _end = (const char*)_addr + _len;
+    return true;
+  }
+
+  void close() {
+    if (_addr) ::munmap(_addr, _len);
+    _addr = nullptr;
+    _begin = _end = nullptr;
+    _len = 0;
+    _open = false;
+  }
+
+  bool is_open() const { return _open; }
+
+  // first byte at the requested offset.
+  const char* begin() const { return _begin; }
+
+  // one past the last byte of the file.
+  const char* end() const { return _end; }
+
+private:
+  void* _addr{nullptr};
+  size_t _len{0};
+  const char* _begin{nullptr};
+  const char* _end{nullptr};
+  bool _open{false};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !MAPPEDRANGE_EZL_H
@@ -14,10 +14,13 @@ private:
   boost::mpi::communicator _comm;
 };
 }
+// if `isThreaded`, MPI is asked for calls from a thread other than main, one
+// at a time, for the flows run on a thread of their own, e.g. by `stream`.
 class Env {
 public:
-  Env(int argc, char* argv[], bool exceptHandle) : _env{argc, argv, exceptHandle} {}
-  Env() : _env{} {}
+  Env(int argc, char* argv[], bool exceptHandle, bool isThreaded = false)
+      : _env{argc, argv, _level(isThreaded), exceptHandle} {}
+  explicit Env(bool isThreaded = false) : _env{_level(isThreaded)} {}
   auto abort(int signal) {
     return _env.abort(signal);
   }
@@ -25,23 +28,49 @@ public:
     return _env;
   }
 private:
+  static boost::mpi::threading::level _level(bool isThreaded) {
+    return isThreaded ? boost::mpi::threading::serialized
+                      : boost::mpi::threading::single;
+  }
   boost::mpi::environment _env;
 };
+// the ranks are the processes, see NOMPI runRanks.
+template <class F> void runRanks(int, F &&f) { f(); }
 }
 #else
+#include <memory>
+#include <stdexcept>
+
+#include <ezl/helper/ThreadComm.hpp>
+
 namespace ezl {
 namespace detail {
+// ranks run as threads by runRanks, with messages through their ThreadHub.
 class CommWrapper {
 public:
-  auto rank() { return 0; }
-  auto size() { return 1; }
+  int rank() const { return rankCtx().rank; }
+  int size() const { return rankCtx().size; }
   const auto &internal() const { return *this; }
+  void send(int dst, int tag, std::shared_ptr<void> msg = nullptr) const {
+    _hub().send(rank(), dst, tag, std::move(msg));
+  }
+  // message from src, or from any rank if src is negative.
+  bool recv(int &src, int tag, std::shared_ptr<void> &msg,
+            bool wait = true) const {
+    return _hub().recv(rank(), src, tag, msg, wait);
+  }
+  size_t queued(int dst, int tag) const { return _hub().queued(dst, tag); }
+private:
+  ThreadHub &_hub() const {
+    if (!rankCtx().hub) throw std::logic_error("no ranks to message.");
+    return *rankCtx().hub;
+  }
 };
 }
 class Env {
 public:
-  Env(int argc, char* argv[], bool exceptHandle) {}
-  Env() {}
+  Env(int argc, char* argv[], bool exceptHandle, bool isThreaded = false) {}
+  explicit Env(bool isThreaded = false) {}
   auto abort(int signal) {
     return signal;
   }
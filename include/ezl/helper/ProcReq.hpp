@@ -37,6 +37,16 @@ inline llmode& operator |= (llmode& lhs, llmode rhs) {
   return lhs;
 }
 
+/*!
+ * @ingroup helper
+ * Request for the number of threads in each process of a unit, e.g.
+ * `prll(threads(4))`. With zero it is the number of hardware threads.
+ * */
+struct threads {
+  explicit threads(size_t n = 0) : count{n} {}
+  size_t count;
+};
+
 /*!
  * @ingroup helper
  * Process request formed according to the user arguments for a task.
@@ -0,0 +1,62 @@
+/*!
+ * @file
+ * class RowRange, a batch of rows in memory kept elsewhere.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef ROWRANGE_EZL_H
+#define ROWRANGE_EZL_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * A range of rows [first, last) that is not owned, returned by a rise UDF
+ * to pass a batch of rows without copying them. Like an empty vector, an
+ * empty range marks the end of data. The rows are to stay valid till the
+ * next call to the UDF.
+ *
+ * Example UDF:
+ * [&v, i = 0]() mutable {
+ *   auto first = std::begin(v) + i;
+ *   i = std::min(i + 1024, int(v.size()));
+ *   return makeRowRange(first, std::begin(v) + i);
+ * };
+ * */
+template <class It>
+struct RowRange {
+  using value_type = typename std::iterator_traits<It>::value_type;
+  using const_iterator = It;
+  It first;
+  It last;
+  It begin() const { return first; }
+  It end() const { return last; }
+  bool empty() const { return first == last; }
+  size_t size() const { return size_t(std::distance(first, last)); }
+};
+
+template <class It>
+auto makeRowRange(It first, It last) {
+  return RowRange<It>{first, last};
+}
+
+namespace meta {
+template <class T> struct isRowRange : public std::false_type {};
+template <class It>
+struct isRowRange<RowRange<It>> : public std::true_type {};
+} // namespace meta
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !ROWRANGE_EZL_H
@@ -0,0 +1,141 @@
+/*!
+ * @file
+ * class RowStream, the output rows of a running flow.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef ROWSTREAM_EZL_H
+#define ROWSTREAM_EZL_H
+
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ezl/helper/BatchQueue.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * The output rows of a flow that runs on a thread of its own, given to the
+ * consumer in batches as they reach the end of the flow. At most `depth`
+ * batches are kept waiting, the flow waits for the consumer beyond that.
+ * This is returned by `stream` of a dataflow.
+ *
+ * If the stream is destroyed before all the rows are taken, the flow still
+ * runs till the end but the rest of the rows are dropped. An exception in
+ * the flow is rethrown while taking the rows. No other flow is to be run
+ * while the stream is running.
+ *
+ * With MPI the library needs to allow the calls from a thread other than
+ * main, i.e. `ezl::Env` is made with `isThreaded`, `stream` throws else.
+ *
+ * Example usage:
+ * @code
+ * auto st = rise(...).map(...).stream();
+ * for (const auto& row : st) { ... }
+ * // or in batches
+ * std::vector<tuple<...>> batch;
+ * while (st.next(batch)) { ... }
+ * @endcode
+ * */
+template <class Row>
+class RowStream {
+public:
+  using Batch = std::vector<Row>;
+
+  /*!
+   * runs `run(push)` on a thread, which calls `push(Batch&&)` with the rows
+   * and stops pushing when it returns false.
+   * */
+  template <class F>
+  RowStream(F run, size_t depth) {
+    _queue = std::make_unique<BatchQueue<Row>>();
+    _queue->start(1, 1, true, depth,
+                  [run](size_t, auto& push) { run(push); });
+  }
+
+  /*!
+   * takes the next batch of rows in `batch`.
+   * @return false if the flow is done and all the rows are taken.
+   * */
+  bool next(Batch& batch) {
+    if (_pos < _batch.size()) {  // rest of the batch taken by rows
+      batch.assign(std::make_move_iterator(std::begin(_batch) + _pos),
+                   std::make_move_iterator(std::end(_batch)));
+      _batch.clear();
+      _pos = 0;
+      return true;
+    }
+    return _pop(batch);
+  }
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Row*;
+    using reference = Row&;
+
+    iterator(RowStream* st = nullptr) : _st{st} {}
+    reference operator*() const { return _st->_batch[_st->_pos]; }
+    pointer operator->() const { return &**this; }
+    iterator& operator++() {
+      if (!_st->_advance()) _st = nullptr;
+      return *this;
+    }
+    bool operator==(const iterator& other) const { return _st == other._st; }
+    bool operator!=(const iterator& other) const { return _st != other._st; }
+
+  private:
+    RowStream* _st;
+  };
+
+  // iterator over the rows, the stream can be iterated only once.
+  iterator begin() {
+    if (!_isBegun) {
+      _isBegun = true;
+      _pos = 0;
+      _batch.clear();
+      if (!_fill()) return end();
+    }
+    return (_pos < _batch.size()) ? iterator{this} : end();
+  }
+
+  iterator end() { return iterator{}; }
+
+private:
+  bool _advance() {
+    if (++_pos < _batch.size()) return true;
+    return _fill();
+  }
+
+  bool _fill() {
+    _pos = 0;
+    while (_pop(_batch)) {
+      if (!_batch.empty()) return true;
+    }
+    _batch.clear();
+    return false;
+  }
+
+  bool _pop(Batch& batch) { return _queue->pop(batch); }
+
+  std::unique_ptr<BatchQueue<Row>> _queue;
+  Batch _batch;
+  size_t _pos{0};
+  bool _isBegun{false};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !ROWSTREAM_EZL_H
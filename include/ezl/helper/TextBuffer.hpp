@@ -0,0 +1,195 @@
+/*!
+ * @file
+ * class TextBuffer, formatting of the rows as text in a reusable buffer.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef TEXTBUFFER_EZL_H
+#define TEXTBUFFER_EZL_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ezl/helper/meta/prettyprint.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Separators for the columns and rows of the text output. The default is
+ * same as the output stream with prettyprint, i.e. `(1, 2.5, abc)` for a
+ * row.
+ * */
+struct TextFormat {
+  std::string open{"("};
+  std::string colSep{", "};
+  std::string close{")"};
+  std::string rowSep{"\n"};
+};
+
+/*!
+ * @ingroup helper
+ * Appends the values as text to a buffer that is kept across the rows, so
+ * that there is no allocation after it grows to its size. The numbers are
+ * written without the stream and locale, the text is same as an output
+ * stream with default flags, i.e. a real number has six significant digits.
+ * Containers, pairs and tuples inside a column are written as prettyprint
+ * does, and the rest of the types through their `operator<<`.
+ *
+ * Example usage:
+ * @code
+ * TextBuffer buf;
+ * buf.row(std::make_tuple(1, 2.5, "abc"), TextFormat{});  // "(1, 2.5, abc)\n"
+ * os.write(buf.data(), buf.size());
+ * buf.clear();
+ * @endcode
+ * */
+class TextBuffer {
+public:
+  const char* data() const { return _buf.data(); }
+
+  size_t size() const { return _size; }
+
+  void clear() { _size = 0; }
+
+  void put(const char* s, size_t n) {
+    if (_size + n > _buf.size()) {
+      _buf.resize(std::max(_size + n, 2 * _buf.size()));
+    }
+    std::memcpy(&_buf[_size], s, n);
+    _size += n;
+  }
+
+  void put(const std::string& s) { put(s.data(), s.size()); }
+
+  void put(const char* s) { put(s, std::strlen(s)); }
+
+  void put(char c) { put(&c, 1); }
+
+  void put(signed char c) { put(char(c)); }
+
+  void put(unsigned char c) { put(char(c)); }
+
+  void put(bool b) { put(b ? '1' : '0'); }
+
+  template <class T>
+  std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>
+  put(T val) {
+    using U = std::make_unsigned_t<T>;
+    if (val < 0) {
+      put('-');
+      _putUnsigned(U(0) - U(val));
+    } else {
+      _putUnsigned(U(val));
+    }
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>
+  put(T val) {
+    _putUnsigned(val);
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_floating_point<T>::value> put(T val) {
+    char s[64];
+    auto n = std::is_same<T, long double>::value
+                 ? std::snprintf(s, sizeof(s), "%.6Lg", (long double)val)
+                 : std::snprintf(s, sizeof(s), "%.6g", (double)val);
+    put(s, size_t(n));
+  }
+
+  template <class... Ts>
+  void put(const std::tuple<Ts...>& val) {
+    using D = pretty_print::delimiters<std::tuple<Ts...>, char>;
+    put(D::values.prefix);
+    _putCols(val, D::values.delimiter, std::index_sequence_for<Ts...>{});
+    put(D::values.postfix);
+  }
+
+  template <class T1, class T2>
+  void put(const std::pair<T1, T2>& val) {
+    using D = pretty_print::delimiters<std::pair<T1, T2>, char>;
+    put(D::values.prefix);
+    put(val.first);
+    put(D::values.delimiter);
+    put(val.second);
+    put(D::values.postfix);
+  }
+
+  // containers e.g. std::array, std::vector
+  template <class T>
+  std::enable_if_t<pretty_print::is_container<T>::value> put(const T& val) {
+    using D = pretty_print::delimiters<T, char>;
+    put(D::values.prefix);
+    auto isFirst = true;
+    for (const auto& it : val) {
+      if (!isFirst) put(D::values.delimiter);
+      isFirst = false;
+      put(it);
+    }
+    put(D::values.postfix);
+  }
+
+  // rest of the types through the stream.
+  template <class T>
+  std::enable_if_t<!std::is_arithmetic<T>::value &&
+                   !pretty_print::is_container<T>::value>
+  put(const T& val) {
+    _ss.str("");
+    _ss << val;
+    put(_ss.str());
+  }
+
+  /*!
+   * appends the columns of the row `val` with the separators of `fmt`.
+   * */
+  template <class... Ts>
+  void row(const std::tuple<Ts...>& val, const TextFormat& fmt) {
+    put(fmt.open);
+    _putCols(val, fmt.colSep, std::index_sequence_for<Ts...>{});
+    put(fmt.close);
+    put(fmt.rowSep);
+  }
+
+private:
+  template <class T>
+  void _putUnsigned(T val) {
+    char s[24];
+    auto p = s + sizeof(s);
+    do {
+      *--p = char('0' + val % 10);
+      val /= 10;
+    } while (val);
+    put(p, size_t(s + sizeof(s) - p));
+  }
+
+  template <class Tup, class S, size_t... is>
+  void _putCols(const Tup& val, const S& sep, std::index_sequence<is...>) {
+    auto i = 0;
+    (void)std::initializer_list<int>{
+        (i++ ? put(sep) : void(), put(std::get<is>(val)), 0)...};
+  }
+
+  std::vector<char> _buf;
+  size_t _size{0};
+  std::ostringstream _ss;
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !TEXTBUFFER_EZL_H
@@ -0,0 +1,188 @@
+/*!
+ * @file
+ * class ThreadHub and function runRanks, for running the ranks as threads
+ * of a process with NOMPI.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef THREADCOMM_EZL_H
+#define THREADCOMM_EZL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * In-memory messages between the ranks that run as threads of a process.
+ * A message is a pointer to a value of the sender, e.g. a vector of rows,
+ * that is queued for the receiving rank on a tag. The messages from a rank
+ * on a tag are received in the order they are sent, like with MPI. The
+ * sender and the receiver agree on the type of value for a tag, as the tags
+ * are given in the same order to the units on every rank.
+ *
+ * If a rank fails the rest are woken up with an exception on their next
+ * call, so that none of them keeps waiting for it.
+ * */
+class ThreadHub {
+public:
+  ThreadHub(int nRanks) : _nRanks{nRanks} {}
+
+  int size() const { return _nRanks; }
+
+  void send(int src, int dst, int tag, std::shared_ptr<void> msg) {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      _check();
+      _boxes[std::make_pair(dst, tag)].emplace_back(src, std::move(msg));
+    }
+    _cv.notify_all();
+  }
+
+  /*!
+   * takes the first message for `dst` on `tag` from `src`, or from any rank
+   * if `src` is negative.
+   * @param wait whether to wait for a message if there is none.
+   * @return false if there is no message and not `wait`.
+   * */
+  bool recv(int dst, int &src, int tag, std::shared_ptr<void> &msg,
+            bool wait) {
+    std::unique_lock<std::mutex> lock{_mut};
+    while (true) {
+      _check();
+      auto box = _boxes.find(std::make_pair(dst, tag));
+      if (box != std::end(_boxes)) {
+        auto &q = box->second;
+        auto it = std::find_if(std::begin(q), std::end(q), [src](auto &m) {
+          return src < 0 || m.first == src;
+        });
+        if (it != std::end(q)) {
+          src = it->first;
+          msg = std::move(it->second);
+          q.erase(it);
+          if (q.empty()) _boxes.erase(box);
+          return true;
+        }
+      }
+      if (!wait) return false;
+      _cv.wait(lock);
+    }
+  }
+
+  // number of messages for `dst` on `tag` not yet received.
+  size_t queued(int dst, int tag) {
+    std::lock_guard<std::mutex> lock{_mut};
+    _check();
+    auto box = _boxes.find(std::make_pair(dst, tag));
+    return box == std::end(_boxes) ? 0 : box->second.size();
+  }
+
+  // records the failure of a rank and wakes up the rest.
+  void abort(std::exception_ptr err) {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      if (!_error) _error = err;
+    }
+    _cv.notify_all();
+  }
+
+  std::exception_ptr error() {
+    std::lock_guard<std::mutex> lock{_mut};
+    return _error;
+  }
+
+private:
+  void _check() const {
+    if (_error) throw std::runtime_error("another rank has failed.");
+  }
+
+  int _nRanks;
+  std::map<std::pair<int, int>, std::deque<std::pair<int, std::shared_ptr<void>>>>
+      _boxes;
+  std::mutex _mut;
+  std::condition_variable _cv;
+  std::exception_ptr _error{nullptr};
+};
+
+/*!
+ * @ingroup helper
+ * rank of the thread and the hub of its ranks, the thread is rank zero of
+ * one if it is not run by `runRanks`.
+ * */
+struct RankCtx {
+  int rank{0};
+  int size{1};
+  ThreadHub *hub{nullptr};
+};
+
+inline RankCtx &rankCtx() {
+  thread_local RankCtx ctx;
+  return ctx;
+}
+
+} // namespace detail
+
+/*!
+ * @ingroup helper
+ * Runs `f` on `n` threads, each as a rank of the program like the processes
+ * of MPI, for parallelism on the cores of a machine without MPI. Each rank
+ * has its own `Karta`, and the `MPIBridge` of the units with `prll` is a
+ * `QueueBridge` that passes the rows between the ranks in memory. If `n` is
+ * zero there is a rank for each core.
+ *
+ * Unlike processes, the ranks share the memory, so `f` is to not modify the
+ * variables that it captures, or the static variables, without a lock.
+ * An exception in a rank is rethrown after all the ranks are done.
+ *
+ * With MPI it simply calls `f`, as the ranks are the processes.
+ *
+ * Example usage:
+ * @code
+ * ezl::runRanks(4, [] {
+ *   ezl::rise(ezl::iota(1000))
+ *     .map([](int i) { return i % 10; })
+ *     .reduce<2>(ezl::count(), 0).dump()
+ *     .run();
+ * });
+ * @endcode
+ * */
+template <class F>
+void runRanks(int n, F &&f) {
+  if (n <= 0) n = std::max(int(std::thread::hardware_concurrency()), 1);
+  auto hub = std::make_shared<detail::ThreadHub>(n);
+  std::vector<std::thread> ranks;
+  ranks.reserve(n);
+  for (auto i = 0; i < n; ++i) {
+    ranks.emplace_back([&f, hub, i, n] {
+      detail::rankCtx() = detail::RankCtx{i, n, hub.get()};
+      try {
+        f();
+      } catch (...) {
+        hub->abort(std::current_exception());
+      }
+    });
+  }
+  for (auto &it : ranks) it.join();
+  auto err = hub->error();
+  if (err) std::rethrow_exception(err);
+}
+
+} // namespace ezl
+
+#endif // !THREADCOMM_EZL_H
@@ -0,0 +1,192 @@
+/*!
+ * @file
+ * function gatherRows for collecting the rows of all the processes.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef GATHERROWS_EZL_H
+#define GATHERROWS_EZL_H
+
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifndef NOMPI
+#include <boost/mpi.hpp>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+#include <ezl/helper/meta/serializeTuple.hpp>
+#endif
+
+#include <ezl/helper/Karta.hpp>
+
+namespace ezl {
+namespace detail {
+
+#ifdef NOMPI
+// tag for the rows of the ranks run as threads, Karta allots the tags of the
+// units from one.
+constexpr int gatherTag = -1;
+#endif
+
+/*!
+ * @ingroup helper
+ * Collects the `rows` of all the processes in the order of their ranks, in
+ * `rows` of the process with rank `root`, or of every process if `root` is
+ * negative. The rest of the processes are left with no rows.
+ *
+ * The rows of a process are serialized in batches of at most `batchBytes`,
+ * and a batch of each process is collected in a round with a single
+ * `MPI_Gatherv` or `MPI_Allgatherv`, preceded by a gather of the sizes.
+ * The batches keep the counts and displacements of a round in range of an
+ * int for any number of rows.
+ *
+ * It is to be called by all the processes. With a single process the rows
+ * are left as they are. With NOMPI the ranks run by `runRanks` pass their
+ * rows in memory.
+ * */
+template <class Row>
+void gatherRows(std::vector<Row>& rows, int root = -1,
+                size_t batchBytes = size_t(1) << 26) {
+#ifndef NOMPI
+  const auto& world = Karta::inst().comm();
+  const int nProc = world.size();
+  if (nProc < 2) return;
+  const auto isAll = root < 0;
+  const auto isRecv = isAll || world.rank() == root;
+  batchBytes = std::max(size_t(1),
+                        std::min(batchBytes, size_t(INT_MAX / nProc / 2)));
+  using Buffer = boost::mpi::packed_oarchive::buffer_type;
+  // serialized batches of the rows of the process with number of rows in each
+  std::vector<Buffer> batches;
+  std::vector<int> batchRows;
+  for (auto it = std::begin(rows); it != std::end(rows);) {
+    batches.emplace_back();
+    batchRows.push_back(0);
+    boost::mpi::packed_oarchive oa{MPI_Comm(world), batches.back()};
+    while (it != std::end(rows) && batches.back().size() < batchBytes) {
+      oa << *it++;
+      ++batchRows.back();
+    }
+  }
+  int nBatch = batches.size(), nRound = 0;
+  MPI_Allreduce(&nBatch, &nRound, 1, MPI_INT, MPI_MAX, MPI_Comm(world));
+  std::vector<std::vector<Row>> byRank(isRecv ? nProc : 0);
+  if (isRecv) byRank[world.rank()] = std::move(rows);
+  rows.clear();
+  std::vector<int> counts(isRecv ? 2 * nProc : 0);
+  std::vector<int> bytes(nProc), displs(nProc);
+  Buffer sendBuf, recvBuf;
+  for (auto i = 0; i < nRound; ++i) {
+    int local[2] = {0, 0};
+    auto& buf = (i < nBatch) ? batches[i] : sendBuf;
+    if (i < nBatch) {
+      local[0] = buf.size();
+      local[1] = batchRows[i];
+    }
+    if (isAll) {
+      MPI_Allgather(local, 2, MPI_INT, counts.data(), 2, MPI_INT,
+                    MPI_Comm(world));
+    } else {
+      MPI_Gather(local, 2, MPI_INT, counts.data(), 2, MPI_INT, root,
+                 MPI_Comm(world));
+    }
+    if (isRecv) {
+      auto total = 0;
+      for (auto r = 0; r < nProc; ++r) {
+        bytes[r] = counts[2 * r];
+        displs[r] = total;
+        total += bytes[r];
+      }
+      recvBuf.resize(std::max(total, 1));
+    }
+    if (isAll) {
+      MPI_Allgatherv(buf.data(), local[0], MPI_PACKED, recvBuf.data(),
+                     bytes.data(), displs.data(), MPI_PACKED, MPI_Comm(world));
+    } else {
+      MPI_Gatherv(buf.data(), local[0], MPI_PACKED, recvBuf.data(),
+                  bytes.data(), displs.data(), MPI_PACKED, root,
+                  MPI_Comm(world));
+    }
+    if (i < nBatch) Buffer{}.swap(batches[i]);  // releases the sent batch
+    if (!isRecv) continue;
+    for (auto r = 0; r < nProc; ++r) {
+      if (r == world.rank() || counts[2 * r + 1] == 0) continue;
+      boost::mpi::packed_iarchive ia{MPI_Comm(world), recvBuf,
+                                     boost::archive::no_header, displs[r]};
+      auto& cur = byRank[r];
+      cur.reserve(cur.size() + counts[2 * r + 1]);
+      for (auto j = 0; j < counts[2 * r + 1]; ++j) {
+        cur.emplace_back();
+        ia >> cur.back();
+      }
+    }
+  }
+  if (!isRecv) return;
+  size_t total = 0;
+  for (const auto& it : byRank) total += it.size();
+  rows.reserve(total);
+  for (auto& it : byRank) {
+    std::move(std::begin(it), std::end(it), std::back_inserter(rows));
+  }
+#else
+  // ranks run as threads share a vector of the rows in place of batches.
+  (void)batchBytes;
+  const auto& comm = Karta::inst().comm();
+  const int nProc = comm.size();
+  if (nProc < 2) return;
+  const auto isAll = root < 0;
+  const auto rank = comm.rank();
+  if (!isAll && rank != root) {
+    comm.send(root, gatherTag, std::make_shared<std::vector<Row>>(std::move(rows)));
+    rows.clear();
+    return;
+  }
+  if (isAll) {
+    auto mine = std::make_shared<std::vector<Row>>(rows);
+    for (auto r = 0; r < nProc; ++r) {
+      if (r != rank) comm.send(r, gatherTag, mine);
+    }
+  }
+  std::vector<std::vector<Row>> byRank(nProc);
+  byRank[rank] = std::move(rows);
+  rows.clear();
+  size_t total = byRank[rank].size();
+  std::vector<std::shared_ptr<void>> msgs(nProc);
+  for (auto r = 0; r < nProc; ++r) {
+    if (r == rank) continue;
+    auto src = r;
+    comm.recv(src, gatherTag, msgs[r]);
+    total += std::static_pointer_cast<std::vector<Row>>(msgs[r])->size();
+  }
+  rows.reserve(total);
+  for (auto r = 0; r < nProc; ++r) {
+    if (r == rank) {
+      std::move(std::begin(byRank[r]), std::end(byRank[r]),
+                std::back_inserter(rows));
+      continue;
+    }
+    auto& cur = *std::static_pointer_cast<std::vector<Row>>(msgs[r]);
+    if (isAll) {
+      rows.insert(std::end(rows), std::begin(cur), std::end(cur));
+    } else {
+      std::move(std::begin(cur), std::end(cur), std::back_inserter(rows));
+    }
+  }
+#endif
+}
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !GATHERROWS_EZL_H
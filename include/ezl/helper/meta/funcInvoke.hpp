@@ -14,6 +14,7 @@
 #ifndef FUNCINVOKE_EZL_H
 #define FUNCINVOKE_EZL_H
 
+#include <memory>
 #include <vector>
 #include <tuple>
 #include <type_traits>
@@ -33,6 +34,10 @@ template<typename T> struct isVector : public std::false_type {};
 template<typename T, typename A>
 struct isVector<std::vector<T, A>> : public std::true_type {};
 
+template<typename T> struct isSharedPtr : public std::false_type {};
+template<typename T>
+struct isSharedPtr<std::shared_ptr<T>> : public std::true_type {};
+
 // to test if a function type can be called with the given argument types
 // @source
 // http://stackoverflow.com/questions/22882170/c-compile-time-predicate-to-test-if-a-callable-object-of-type-f-can-be-called
@@ -12,7 +12,17 @@
 #ifndef LEXCASTTUPLE_EZL_H
 #define LEXCASTTUPLE_EZL_H
 
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include <boost/lexical_cast.hpp>  // compile time increase by 2 secs!
@@ -21,75 +31,261 @@ namespace ezl {
 namespace detail {
 namespace meta {
 
-// converts string values into tuple, uses boost-lexical
-// throws exception boost::bad_lexical_cast if string can not be converted to
-// the tuple datatype. std::array of some type is also supported.
+// integral types other than bool and characters are parsed by parseInt.
+template <class T>
+using IsFastInt = std::integral_constant<bool,
+      std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+      !std::is_same<T, char>::value && !std::is_same<T, signed char>::value &&
+      !std::is_same<T, unsigned char>::value &&
+      !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value &&
+      !std::is_same<T, char32_t>::value>;
+
+template <class T>
+using IsFastReal = std::integral_constant<bool,
+      std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+// decimal integer with an optional sign, false if there is any other
+// character or if the value overflows T.
+template <class T>
+bool parseInt(const char* first, const char* last, T& out) {
+  using U = std::make_unsigned_t<T>;
+  if (first == last) return false;
+  auto neg = false;
+  if (*first == '-' || *first == '+') {
+    neg = (*first == '-');
+    if (neg && !std::is_signed<T>::value) return false;
+    if (++first == last) return false;
+  }
+  const U limit = neg ? U(U(std::numeric_limits<T>::max()) + 1)
+                      : U(std::numeric_limits<T>::max());
+  U val = 0;
+  for (; first != last; ++first) {
+    auto d = unsigned(*first) - unsigned('0');
+    if (d > 9 || val > (limit - d) / 10) return false;
+    val = val * 10 + d;
+  }
+  out = neg ? T(U(0) - val) : T(val);
+  return true;
+}
+
+// strtod family for the cases the fast path does not handle exactly: long
+// mantissas, large exponents, inf, nan.
+inline bool strToReal(const char* s, char** end, float& out) {
+  out = std::strtof(s, end);
+  return true;
+}
+
+inline bool strToReal(const char* s, char** end, double& out) {
+  out = std::strtod(s, end);
+  return true;
+}
+
+template <class T>
+bool parseRealSlow(const char* first, const char* last, T& out) {
+  const auto len = size_t(last - first);
+  if (len == 0 || std::isspace((unsigned char)*first)) return false;
+  char buf[64];
+  std::string big;
+  const char* s = buf;
+  if (len < sizeof(buf)) {
+    std::memcpy(buf, first, len);
+    buf[len] = '\0';
+  } else {
+    big.assign(first, last);
+    s = big.c_str();
+  }
+  char* end;
+  errno = 0;
+  strToReal(s, &end, out);
+  if (end != s + len) return false;
+  return !(errno == ERANGE && std::isinf(out));
+}
+
+// exact for mantissa till 2^53 and power of ten till 22 (Clinger's fast
+// path) since both are exact doubles and a single operation is correctly
+// rounded. Rest goes to strtod.
+template <class T>
+bool parseReal(const char* first, const char* last, T& out) {
+  static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+  auto it = first;
+  auto neg = false;
+  if (it != last && (*it == '-' || *it == '+')) {
+    neg = (*it == '-');
+    ++it;
+  }
+  uint64_t mant = 0;
+  int nDigits = 0;
+  int exp10 = 0;
+  auto anyDigit = false;
+  auto exact = true;
+  for (; it != last && unsigned(*it - '0') <= 9; ++it) {
+    anyDigit = true;
+    if (nDigits < 19) {
+      mant = mant * 10 + unsigned(*it - '0');
+      if (mant) ++nDigits;
+    } else {
+      ++exp10;
+      if (*it != '0') exact = false;
+    }
+  }
+  if (it != last && *it == '.') {
+    for (++it; it != last && unsigned(*it - '0') <= 9; ++it) {
+      anyDigit = true;
+      if (nDigits < 19) {
+        mant = mant * 10 + unsigned(*it - '0');
+        if (mant) ++nDigits;
+        --exp10;
+      } else if (*it != '0') {
+        exact = false;
+      }
+    }
+  }
+  if (!anyDigit) return parseRealSlow(first, last, out);  // inf, nan
+  if (it != last && (*it == 'e' || *it == 'E')) {
+    ++it;
+    auto negExp = false;
+    if (it != last && (*it == '-' || *it == '+')) {
+      negExp = (*it == '-');
+      ++it;
+    }
+    if (it == last) return false;
+    int e = 0;
+    for (; it != last && unsigned(*it - '0') <= 9; ++it) {
+      if (e < 10000) e = e * 10 + (*it - '0');
+    }
+    exp10 += negExp ? -e : e;
+  }
+  if (it != last) return false;
+  if (mant == 0) {
+    out = neg ? -T(0) : T(0);
+    return true;
+  }
+  if (!exact || mant > (uint64_t(1) << 53) || exp10 < -22 || exp10 > 22) {
+    return parseRealSlow(first, last, out);
+  }
+  auto d = double(mant);
+  d = (exp10 < 0) ? d / pow10[-exp10] : d * pow10[exp10];
+  if (std::is_same<T, float>::value) {
+    // rounding the double again to float can be off if the double is
+    // exactly halfway between two floats.
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(d));
+    if ((bits & 0x1FFFFFFF) == 0x10000000) {
+      return parseRealSlow(first, last, out);
+    }
+  }
+  out = T(neg ? -d : d);
+  return true;
+}
+
+/*!
+ * converts chars in [first, last) to the type of `out`.
+ * @return false if the chars are not a valid value of the type.
+ * */
+template <class T>
+std::enable_if_t<IsFastInt<T>::value, bool>
+parseField(const char* first, const char* last, T& out) {
+  return parseInt(first, last, out);
+}
+
+template <class T>
+std::enable_if_t<IsFastReal<T>::value, bool>
+parseField(const char* first, const char* last, T& out) {
+  return parseReal(first, last, out);
+}
+
+inline bool parseField(const char* first, const char* last, std::string& out) {
+  out.assign(first, last);
+  return true;
+}
+
+// other types go through boost lexical_cast.
+template <class T>
+std::enable_if_t<!IsFastInt<T>::value && !IsFastReal<T>::value, bool>
+parseField(const char* first, const char* last, T& out) {
+  try {
+    out = boost::lexical_cast<T>(first, size_t(last - first));
+  } catch (const boost::bad_lexical_cast&) {
+    return false;
+  }
+  return true;
+}
+
+// for a std::string or a char range view into a buffer.
+template <class R, class T>
+bool castField(const R& r, T& out, bool strict) {
+  const auto len = std::distance(std::begin(r), std::end(r));
+  if (len == 0 && !strict) {
+    out = T();
+    return true;
+  }
+  const char* first = len ? &*std::begin(r) : nullptr;
+  return parseField(first, first + len, out);
+}
+
+// converts string values into tuple, std::array of some type is also
+// supported. The iterator can be of a container of strings or of char ranges
+// that are views into a buffer (boost::iterator_range<const char*>). Each
+// element type gets its parser at compile time from the parseField
+// overloads. Returns false at the first value that can not be converted.
 // Used struct because a function will require enable if which is kind of 
 // equally complicated.
 template <size_t I, class Tup, class T>
 struct LexCastImpl {
-  LexCastImpl(std::vector<std::string>::iterator& it, Tup &out, bool strict) {
-    using T2 = typename std::remove_reference<T>::type;
+  template <class It>
+  static bool apply(It& it, Tup &out, bool strict) {
     --it;
-    if (!strict && *it == "") {
-      std::get<I>(out) = T2();
-    } else {
-      std::get<I>(out) = boost::lexical_cast<T2>(*it);
-    }
-    LexCastImpl<I - 1, Tup, std::tuple_element_t<I - 1, Tup>>(it, out, strict);
+    return castField(*it, std::get<I>(out), strict) &&
+           LexCastImpl<I - 1, Tup, std::tuple_element_t<I - 1, Tup>>::apply(
+               it, out, strict);
   }
 };
 
 template <size_t I, class Tup, class T, size_t N>
 struct LexCastImpl<I, Tup, std::array<T,N>> {
-  LexCastImpl(std::vector<std::string>::iterator &it, Tup &out, bool strict) {
-    using T2 = typename std::remove_reference<T>::type;
+  template <class It>
+  static bool apply(It &it, Tup &out, bool strict) {
     for(auto i = int(N-1); i >= 0; i--) {
       --it;
-      if (!strict && *it == "") {
-        std::get<I>(out)[i] = T2();
-      } else {
-        std::get<I>(out)[i] = boost::lexical_cast<T2>(*it);
-      }
+      if (!castField(*it, std::get<I>(out)[i], strict)) return false;
     }
-    LexCastImpl<I - 1, Tup, std::tuple_element_t<I - 1, Tup>>(it, out, strict);
+    return LexCastImpl<I - 1, Tup, std::tuple_element_t<I - 1, Tup>>::apply(
+        it, out, strict);
   }
 };
 
 template <class Tup, class T, size_t N>
 struct LexCastImpl<0, Tup, std::array<T, N>> {
-  LexCastImpl(std::vector<std::string>::iterator &it, Tup& out, bool strict) {
-    using T2 = typename std::remove_reference<T>::type;
+  template <class It>
+  static bool apply(It &it, Tup& out, bool strict) {
     for(auto i = int(N-1); i >= 0; i--) {
       --it;
-      if (!strict && *it == "") {
-        std::get<0>(out)[i] = T2();
-      } else {
-        std::get<0>(out)[i] = boost::lexical_cast<T2>(*it);
-      }
+      if (!castField(*it, std::get<0>(out)[i], strict)) return false;
     }
+    return true;
   }
 };
 
 template <class Tup, class T>
 struct LexCastImpl<0, Tup, T> {
-  LexCastImpl(std::vector<std::string>::iterator &it, Tup &out, bool strict) {
-    using T2 = typename std::remove_reference<T>::type;
+  template <class It>
+  static bool apply(It &it, Tup &out, bool strict) {
     --it;
-    if (!strict && *it == "") {
-      std::get<0>(out) = T2();
-    } else {
-      std::get<0>(out) = boost::lexical_cast<T2>(*it); // TODO: catch
-    }
+    return castField(*it, std::get<0>(out), strict);
   }
 };
 
-// wrapper functions for string tuple conversion
-template <class Tup>
-void lexCastTuple(std::vector<std::string> &vstr, Tup &out, bool strict = true) {
+// wrapper functions for string tuple conversion, false if any of the values
+// can not be converted, `out` is then partially filled.
+template <class C, class Tup>
+bool lexCastTuple(C &vstr, Tup &out, bool strict = true) {
   constexpr auto tupSize = std::tuple_size<Tup>::value - 1;
   auto it = std::end(vstr);
-  LexCastImpl<tupSize, Tup, std::tuple_element_t<tupSize, Tup>>(it, out, strict);
+  return LexCastImpl<tupSize, Tup, std::tuple_element_t<tupSize, Tup>>::apply(
+      it, out, strict);
 };
 
 } // namespace meta
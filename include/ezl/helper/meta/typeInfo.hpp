@@ -18,6 +18,7 @@
 
 #include <boost/functional/hash.hpp>
 
+#include <ezl/helper/RowRange.hpp>
 #include <ezl/helper/meta/funcInvoke.hpp>
 #include <ezl/helper/meta/slctTuple.hpp>
 #include <ezl/helper/meta/slct.hpp>
@@ -242,6 +243,11 @@ template <class F, class T, class A> struct RiseTypesImpl<F, std::vector<T, A>>
   using type = typename meta::SlctTupleRefType<typename GetTupleType<T>::type>::type;
 };
 
+template <class F, class It> struct RiseTypesImpl<F, RowRange<It>> {
+  using type = typename meta::SlctTupleRefType<
+      typename GetTupleType<typename RowRange<It>::value_type>::type>::type;
+};
+
 // types for Rise
 template <class F> 
 struct RiseTypes : RiseTypesImpl<F, decltype(std::declval<F>()())> {};
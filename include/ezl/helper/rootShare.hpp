@@ -0,0 +1,79 @@
+/*!
+ * @file
+ * function rootShare for computing a value on one process and sending it to
+ * the rest of the processes of a unit.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef ROOTSHARE_EZL_H
+#define ROOTSHARE_EZL_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#ifndef NOMPI
+#include <boost/mpi.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+#endif
+
+#include <ezl/helper/Karta.hpp>
+
+namespace ezl {
+namespace detail {
+
+// Karta allots the tags of the units from one, zero is kept for the
+// messages of the rises, i.e. rootShare and ChunkQueue.
+constexpr int riseTag = 0;
+
+/*!
+ * @ingroup helper
+ * Returns the value of `f` computed on the process at first position of
+ * `procs` and sent to the rest of them along a binomial tree. This is used
+ * for the queries to the file system like glob and stat, that would
+ * otherwise be made by every process at the same time.
+ *
+ * It is to be called by all the processes in `procs` in the same order, as
+ * is the case for the calls made by rise before the data flow. If `procs`
+ * are not the ranks of the running processes, e.g. with NOMPI or when
+ * called for a position other than the process's own, `f` is computed by
+ * the process itself. The value needs to be serializable with boost.
+ * */
+template <class F>
+auto rootShare(int pos, const std::vector<int>& procs, F&& f) {
+  using T = decltype(f());
+#ifndef NOMPI
+  const auto& comm = Karta::inst().comm();
+  const int n = procs.size();
+  auto isRanks = pos >= 0 && pos < n && procs[pos] == comm.rank() &&
+                 std::all_of(std::begin(procs), std::end(procs),
+                             [&comm](int r) { return r < comm.size(); });
+  if (n < 2 || !isRanks) return f();
+  T val;
+  if (pos == 0) val = f();
+  for (int mask = 1; mask < n; mask <<= 1) {
+    if (pos < mask) {
+      if (pos + mask < n) comm.send(procs[pos + mask], riseTag, val);
+    } else if (pos < 2 * mask) {
+      comm.recv(procs[pos - mask], riseTag, val);
+    }
+  }
+  return val;
+#else
+  (void)pos;
+  (void)procs;
+  return T(f());
+#endif
+}
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !ROOTSHARE_EZL_H
@@ -0,0 +1,138 @@
+/*!
+ * @file
+ * function sharedWrite for the processes of a unit to write to one file.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef SHAREDWRITE_EZL_H
+#define SHAREDWRITE_EZL_H
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef NOMPI
+#include <boost/mpi.hpp>
+#endif
+
+#include <ezl/helper/Karta.hpp>
+
+namespace ezl {
+namespace detail {
+
+#ifdef NOMPI
+// tag for the turns of the ranks run as threads to write.
+constexpr int writeTag = -2;
+#endif
+
+/*!
+ * @ingroup helper
+ * Appends the bytes [data, data + n) of each process in `procs` to the file
+ * `fname`, in the order of the positions of the processes. Each process
+ * writes its bytes at its own offset, i.e. the size of the file plus the
+ * bytes of the processes before it (exclusive prefix sum), with collective
+ * MPI-IO over a communicator of just the `procs`.
+ *
+ * It is to be called by all the processes in `procs`. If `procs` are not
+ * the ranks of the running processes the bytes are appended by the process
+ * itself. With NOMPI the ranks run by `runRanks` append one after another.
+ * @return false if the file can not be written.
+ * */
+inline bool sharedWrite(const std::string& fname, int pos,
+                        const std::vector<int>& procs, const char* data,
+                        size_t n) {
+#ifndef NOMPI
+  const auto& world = Karta::inst().comm();
+  const int nProc = procs.size();
+  auto isRanks = nProc > 1 && pos >= 0 && pos < nProc &&
+                 procs[pos] == world.rank() &&
+                 std::all_of(std::begin(procs), std::end(procs),
+                             [&world](int r) { return r < world.size(); });
+  if (isRanks) {
+    // only the processes in the group take part in creating its comm.
+    MPI_Group worldGroup, group;
+    MPI_Comm comm;
+    MPI_Comm_group(MPI_Comm(world), &worldGroup);
+    MPI_Group_incl(worldGroup, nProc, procs.data(), &group);
+    MPI_Comm_create_group(MPI_Comm(world), group, 0, &comm);
+    MPI_Group_free(&group);
+    MPI_Group_free(&worldGroup);
+    MPI_File fh;
+    auto err = MPI_File_open(comm, fname.c_str(),
+                             MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                             MPI_INFO_NULL, &fh);
+    if (err != MPI_SUCCESS) {
+      MPI_Comm_free(&comm);
+      Karta::inst().log("Can not write to file " + fname, LogMode::warning);
+      return false;
+    }
+    long long offset = 0;
+    if (pos == 0) {
+      MPI_Offset size;
+      MPI_File_get_size(fh, &size);
+      offset = size;
+    }
+    MPI_Bcast(&offset, 1, MPI_LONG_LONG, 0, comm);
+    long long len = n, pre = 0, maxLen = 0;
+    MPI_Exscan(&len, &pre, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (pos == 0) pre = 0;  // undefined for the first
+    MPI_Allreduce(&len, &maxLen, 1, MPI_LONG_LONG, MPI_MAX, comm);
+    offset += pre;
+    // the count of a write is an int, all take the same number of rounds.
+    const long long round = 1LL << 30;
+    auto isOk = true;
+    for (auto done = 0LL; done < maxLen; done += round) {
+      auto count = std::max(std::min(len - done, round), 0LL);
+      MPI_Status st;
+      err = MPI_File_write_at_all(fh, offset + std::min(done, len),
+                                  data + std::min(done, len), int(count),
+                                  MPI_CHAR, &st);
+      isOk = isOk && err == MPI_SUCCESS;
+    }
+    MPI_File_close(&fh);
+    MPI_Comm_free(&comm);
+    if (!isOk) {
+      Karta::inst().log("Can not write to file " + fname, LogMode::warning);
+    }
+    return isOk;
+  }
+#else
+  // ranks run as threads append in turns, each after the one before it.
+  const auto& comm = Karta::inst().comm();
+  const int nProc = procs.size();
+  auto isRanks = nProc > 1 && pos >= 0 && pos < nProc &&
+                 procs[pos] == comm.rank() &&
+                 std::all_of(std::begin(procs), std::end(procs),
+                             [&comm](int r) { return r < comm.size(); });
+  if (isRanks && pos > 0) {
+    auto src = procs[pos - 1];
+    std::shared_ptr<void> turn;
+    comm.recv(src, writeTag, turn);
+  }
+#endif
+  bool isOk;
+  {
+    std::ofstream out(fname, std::ios::out | std::ios::app | std::ios::binary);
+    out.write(data, n);
+    isOk = bool(out);
+  }
+#ifdef NOMPI
+  if (isRanks && pos + 1 < nProc) comm.send(procs[pos + 1], writeTag);
+#endif
+  if (!isOk) {
+    Karta::inst().log("Can not write to file " + fname, LogMode::warning);
+  }
+  return isOk;
+}
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !SHAREDWRITE_EZL_H
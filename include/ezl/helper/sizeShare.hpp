@@ -0,0 +1,60 @@
+/*!
+ * @file
+ * function sizeShare for dividing whole files between processes by size.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef SIZESHARE_EZL_H
+#define SIZESHARE_EZL_H
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup helper
+ * Returns the indices of the files in the share of the process at `pos` of
+ * `nProc` processes, when the files are to be read whole. The files are
+ * given largest first, each to the process with the least bytes so far
+ * (longest processing time first), with the fewer files and then the lower
+ * position getting a tie. The indices are in the order of the list. A
+ * negative size is taken as zero.
+ *
+ * Example usage:
+ * @code
+ * sizeShare({40, 10, 10, 10, 10}, 0, 2); // {0}
+ * sizeShare({40, 10, 10, 10, 10}, 1, 2); // {1, 2, 3, 4}
+ * @endcode
+ * */
+inline std::vector<size_t> sizeShare(const std::vector<long long>& sizes,
+                                     int pos, int nProc) {
+  std::vector<size_t> order(sizes.size());
+  std::iota(std::begin(order), std::end(order), 0);
+  std::stable_sort(std::begin(order), std::end(order),
+                   [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+  // bytes and number of files given to each process
+  std::vector<std::pair<long long, size_t>> loads(std::max(nProc, 1));
+  std::vector<size_t> share;
+  for (auto it : order) {
+    auto least = std::min_element(std::begin(loads), std::end(loads));
+    least->first += std::max(sizes[it], 0LL);
+    ++least->second;
+    if (least - std::begin(loads) == pos) share.push_back(it);
+  }
+  std::sort(std::begin(share), std::end(share));
+  return share;
+}
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !SIZESHARE_EZL_H
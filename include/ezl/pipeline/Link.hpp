@@ -39,6 +39,7 @@ public:
   virtual void forwardPar(const Par *pr) override final {
     if (_visited) return;
     _visited = true;
+    _dataBegin(pr);
     if (pr && !this->next().empty()) {
       for (auto &it : this->next()) {
         it.second->forwardPar(pr);
@@ -97,6 +98,7 @@ public:
   }
 
 private:
+  virtual void _dataBegin(const Par *) {} ;
   virtual void _dataEnd(int) {} ;
   bool _traversingRoots{false};
   bool _traversingTasks{false};
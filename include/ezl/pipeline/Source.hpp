@@ -59,6 +59,7 @@ public:
         _next.erase(it.first);
         return false;
       }
+      _flatten();
     }
     return true;
   }
@@ -71,6 +72,7 @@ public:
     auto id = nx->id();
     if (_next.find(id) != std::end(_next)) {
       _next.erase(id); 
+      _flatten();
       nx->unPrev(this); 
     }
   }
@@ -92,8 +94,37 @@ public:
 
   inline const auto &next() const { return _next; }
 
+  /*!
+   * next units as raw pointers in a contiguous list, in the order of
+   * `next()`. It changes only when a next unit is added or removed, i.e.
+   * while the pipeline is built, and stays as it is while it runs.
+   * */
+  inline const auto &nextFlat() const { return _nextFlat; }
+
+  /*!
+   * passes a row or a batch of rows to all the next units. With a single
+   * next unit it is a single call with no loop.
+   * */
+  template <class T>
+  inline void toNext(const T &data) const {
+    if (_nextOne) {
+      _nextOne->dataEvent(data);
+      return;
+    }
+    for (auto nx : _nextFlat) nx->dataEvent(data);
+  }
+
 private:
+  void _flatten() {
+    _nextFlat.clear();
+    _nextFlat.reserve(_next.size());
+    for (const auto &it : _next) _nextFlat.push_back(it.second.get());
+    _nextOne = (_nextFlat.size() == 1) ? _nextFlat[0] : nullptr;
+  }
+
   std::map<int, std::shared_ptr<Dest<Type>>> _next;
+  std::vector<Dest<Type>*> _nextFlat;
+  Dest<Type>* _nextOne {nullptr};
   size_t _id;
 };
 } // namespace ezl
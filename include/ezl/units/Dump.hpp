@@ -13,14 +13,19 @@
 #ifndef DUMP_EZL_H
 #define DUMP_EZL_H
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include <ezl/pipeline/Dest.hpp>
-#include <ezl/helper/meta/prettyprint.hpp>
+#include <ezl/helper/AsyncWriter.hpp>
+#include <ezl/helper/MappedRange.hpp>
+#include <ezl/helper/TextBuffer.hpp>
+#include <ezl/helper/sharedWrite.hpp>
 
 namespace ezl {
 namespace detail {
@@ -30,7 +35,19 @@ namespace detail {
  * A dead end for a pipeline branch dumps data to file(s) or output stream if
  * file name is not specified.
  *
- * If running on multiple processes filename is prefixed with rank.
+ * If running on multiple processes filename is prefixed with rank, unless
+ * `isShared` is set, in which case the processes write to one file in the
+ * order of their positions (see `sharedWrite`). The rows of a process are
+ * then kept till the end of data, those beyond `bufBytes` in a file next to
+ * the output (`<fname>.<pos>.part`) rather than in memory, which is mapped
+ * for the write and removed after it.
+ *
+ * The rows are formatted in a buffer of the unit with the separators of
+ * `TextFormat`. When it has `bufBytes` of them it is handed to a writer
+ * thread of the unit (see `AsyncWriter`) and the rows are formatted in
+ * another buffer meanwhile. At the end of data the rest is written after the
+ * writer is done. The output of different dumps to the standard output
+ * hence comes in blocks rather than rows.
  *
  * This is added to the pipeline when a unit specifies `dump` property.
  * `DumpExpr` has the builder expression for adding it for the current unit
@@ -43,12 +60,16 @@ public:
   using itype = I;
   static constexpr int isize = std::tuple_size<I>::value;
 
-  Dump(std::string fname, std::string head) : _fname{fname}, _header{head} {
+  Dump(std::string fname, std::string head, TextFormat format = TextFormat{},
+       size_t bufBytes = 1 << 20, bool isShared = false)
+      : _fname{fname}, _header{head}, _format{format}, _bufBytes{bufBytes},
+        _isShared{isShared && !fname.empty()} {
     _os = &std::cout;
     _fb = nullptr;
   }
 
   ~Dump() {
+    _writer.finish();
     if (_os != &std::cout) {
       delete _os;
     }
@@ -58,6 +79,15 @@ public:
   virtual void forwardPar(const Par *par) override final {
     if (_parred || !par->inRange()) return;
     _parred = true;
+    _pos = par->pos();
+    _procs = par->procAll();
+    if (_isShared) {
+      if (par->pos() == 0 && !_header.empty()) {
+        _buf.put(_header);
+        _buf.put('\n');
+      }
+      return;
+    }
     if (par && _fname.length() > 0) {
       auto prefname = _fname;
       if (par->nProc() > 1) {
@@ -77,20 +107,31 @@ public:
       }
     }
     if ((par->pos() == 0 || !_fname.empty()) && !_header.empty()) {
-      (*_os)<<_header<<std::endl;
+      _buf.put(_header);
+      _buf.put('\n');
     }
   }
 
   virtual std::vector<Task *> forwardTasks() override final { return std::vector<Task *>{}; }
 
   virtual void dataEvent(const I &data) override final {
-    (*_os)<<data<<'\n';
+    _buf.row(data, _format);
+    if (_buf.size() >= _bufBytes) _flush();
   }
 
   virtual void signalEvent(int i) override final {
     if (i == 0) this->incSig();
     else if (this->decSig() != 0) return;
     _parred = false;
+    if (_isShared) {
+      _writeShared();
+      return;
+    }
+    if (!_writer.finish()) {
+      Karta::inst().log("Can not write to file " + _fname, LogMode::warning);
+    }
+    _os->write(_buf.data(), _buf.size());
+    _buf.clear();
     (*_os)<<std::flush;
     if (_fb) _fb->close();
     // resetting
@@ -99,8 +140,56 @@ public:
   }
 
 private:
+  void _flush() {
+    if (!_isShared) {
+      _writer.write(*_os, _buf);
+      return;
+    }
+    if (!_spill) {
+      _spillName = _fname + "." + std::to_string(_pos) + ".part";
+      _spill = std::make_unique<std::ofstream>(
+          _spillName, std::ios::out | std::ios::trunc | std::ios::binary);
+    }
+    _writer.write(*_spill, _buf);
+  }
+
+  // the bytes of the process from the spill file if the rows are more than
+  // the buffer, the process takes part in the write even if it has failed.
+  void _writeShared() {
+    if (!_spill) {
+      sharedWrite(_fname, _pos, _procs, _buf.data(), _buf.size());
+      _buf.clear();
+      return;
+    }
+    auto isOk = _writer.finish();
+    _spill->write(_buf.data(), _buf.size());
+    _spill->close();
+    _buf.clear();
+    MappedRange mf;
+    isOk = isOk && !_spill->fail() && mf.open(_spillName);
+    if (!isOk) {
+      Karta::inst().log("Can not write to file " + _spillName,
+                        LogMode::warning);
+      mf.close();
+    }
+    sharedWrite(_fname, _pos, _procs, mf.begin(),
+                size_t(mf.end() - mf.begin()));
+    mf.close();
+    _spill.reset();
+    std::remove(_spillName.c_str());
+  }
+
   std::string _fname;
   std::string _header;
+  TextFormat _format;
+  size_t _bufBytes;
+  TextBuffer _buf;
+  AsyncWriter _writer;
+  bool _isShared;
+  int _pos{0};
+  std::vector<int> _procs;
+  std::unique_ptr<std::ofstream> _spill;
+  std::string _spillName;
   std::unique_ptr<std::filebuf> _fb;
   std::ostream *_os;
   bool _parred{false};
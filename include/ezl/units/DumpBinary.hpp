@@ -0,0 +1,121 @@
+/*!
+ * @file
+ * class DumpBinary, unit for dumping to a file in binary columnar format.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+
+#ifndef DUMPBINARY_EZL_H
+#define DUMPBINARY_EZL_H
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ezl/pipeline/Dest.hpp>
+#include <ezl/helper/BinaryColumns.hpp>
+#include <ezl/helper/MappedRange.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup units
+ * A dead end for a pipeline branch that dumps the rows to a file in the
+ * typed binary columnar format of `BinaryColumns`, to be read back with
+ * `fromBinary` without any parsing.
+ *
+ * The rows are kept in columns till there are `blockBytes` of them and are
+ * then written as a block. If running on multiple processes filename is
+ * prefixed with rank as in `Dump`. The rows are appended if the file exists
+ * with the same schema, else the file is not written to.
+ *
+ * This is added to the pipeline when a unit specifies `dumpBinary` property.
+ * */
+template <class I>
+struct DumpBinary : public Dest<I> {
+  static_assert(BinaryRow<I>::supported,
+                "binary columns need to be trivially copyable or string.");
+public:
+  using itype = I;
+  static constexpr int isize = std::tuple_size<I>::value;
+  using Columns = BinaryColumns<typename BinaryRow<I>::type>;
+
+  DumpBinary(std::string fname, size_t blockBytes = 1 << 20)
+      : _fname{fname}, _blockBytes{blockBytes} {}
+
+  virtual void forwardPar(const Par *par) override final {
+    if (_parred || !par->inRange()) return;
+    _parred = true;
+    auto prefname = _fname;
+    if (par->nProc() > 1) {
+      auto dot = prefname.find_last_of(".");
+      if (dot == std::string::npos) dot = prefname.size();
+      prefname = prefname.substr(0, dot) + "_p" + std::to_string(par->rank()) +
+                 prefname.substr(dot);
+    }
+    auto isNew = true;
+    {
+      MappedRange mf;
+      if (mf.open(prefname) && mf.begin() != mf.end()) {
+        isNew = false;
+        if (!Columns::isHeader(mf.begin(), mf.end())) {
+          Karta::inst().log("Can not append to file " + prefname +
+                            " with different columns", LogMode::warning);
+          return;
+        }
+      }
+    }
+    _fb = std::make_unique<std::filebuf>();
+    _fb->open(prefname, std::ios::out | std::ios::app | std::ios::binary);
+    if (!_fb->is_open()) {
+      Karta::inst().log("Can not write to file " + prefname, LogMode::warning);
+      _fb = nullptr;
+      return;
+    }
+    _os = std::make_unique<std::ostream>(_fb.get());
+    if (isNew) *_os << Columns::header();
+  }
+
+  virtual std::vector<Task *> forwardTasks() override final {
+    return std::vector<Task *>{};
+  }
+
+  virtual void dataEvent(const I &data) override final {
+    if (!_os) return;
+    _cols.add(data);
+    if (_cols.bytes() >= _blockBytes) _cols.write(*_os);
+  }
+
+  virtual void signalEvent(int i) override final {
+    if (i == 0) this->incSig();
+    else if (this->decSig() != 0) return;
+    _parred = false;
+    if (_os) {
+      _cols.write(*_os);
+      _os->flush();
+    }
+    // resetting
+    _os = nullptr;
+    _fb = nullptr;
+  }
+
+private:
+  std::string _fname;
+  size_t _blockBytes;
+  Columns _cols;
+  std::unique_ptr<std::filebuf> _fb;
+  std::unique_ptr<std::ostream> _os;
+  bool _parred{false};
+};
+}
+} // namespace ezl ezl::detail
+
+#endif // !DUMPBINARY_EZL_H
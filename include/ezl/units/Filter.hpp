@@ -14,19 +14,64 @@
 #define FILTER_EZL_H
 
 #include <tuple>
+#include <vector>
 
 #include <ezl/pipeline/Link.hpp>
+#include <ezl/units/Fused.hpp>
 #include <ezl/helper/meta/funcInvoke.hpp>
 #include <ezl/helper/meta/slctTuple.hpp>
 
 namespace ezl {
 namespace detail {
 
+/*!
+ * @ingroup units
+ * The predicate of a `Filter` unit on a row or a batch of rows, that passes
+ * the rows that pass to a sink. It is the stage of a `Filter` unit as well
+ * as of a `Fused` unit.
+ * */
+template <class I, class Fslct, class Func, class Oslct>
+struct FilterStage {
+public:
+  using itype = I;
+  using otype = typename meta::SlctTupleRefType<itype, Oslct>::type;
+
+  FilterStage(Func f) : _func(f) {}
+
+  template <class Sink>
+  void apply(const itype &data, Sink &sink) {
+    auto temp = meta::slctTupleRef(data, Fslct{});
+    if (meta::invokeMap(_func, temp) && !sink.empty()) {
+      sink(meta::slctTupleRef(data, Oslct{}));
+    }
+  }
+
+  // the rows of a batch that pass are selected and passed on as a batch.
+  template <class Sink>
+  void apply(const std::vector<itype> &vData, Sink &sink) {
+    std::vector<otype> sel;
+    sel.reserve(vData.size());
+    for (const auto &data : vData) {
+      if (meta::invokeMap(_func, meta::slctTupleRef(data, Fslct{}))) {
+        sel.emplace_back(meta::slctTupleRef(data, Oslct{}));
+      }
+    }
+    if (sel.empty() || sink.empty()) return;
+    sink(sel);
+  }
+
+private:
+  Func _func;
+};
+
 /*!
  * @ingroup units
  * Pipeline unit for filtering rows based on a UDF predicate on selected columns
  * of the row.
  *
+ * The builders make a `Fused` unit of `FilterStage` instead, that can take in
+ * the next map and filter expressions.
+ *
  * See examples for using with builders or unittests for direct use.
  *
  * */
@@ -37,20 +82,20 @@ public:
   using otype = typename meta::SlctTupleRefType<itype, Oslct>::type;
   static constexpr int osize = std::tuple_size<otype>::value;
 
-  Filter(Func f) : _func(f) {}
+  Filter(Func f) : _stage(f) {}
 
   virtual void dataEvent(const itype &data) final override {
-    auto temp = meta::slctTupleRef(data, Fslct{});
-    if (meta::invokeMap(_func, temp) && !this->next().empty()) {
-      auto res = meta::slctTupleRef(data, Oslct{});
-      for (auto &it : this->next())
-        it.second->dataEvent(res);
-    }
+    NextSink<otype> sink{*this};
+    _stage.apply(data, sink);
   }
 
-private:
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    NextSink<otype> sink{*this};
+    _stage.apply(vData, sink);
+  }
 
- Func _func;
+private:
+  FilterStage<I, Fslct, Func, Oslct> _stage;
 };
 }
 } // namespace ezl ezl::detail
@@ -0,0 +1,234 @@
+/*!
+ * @file
+ * class Fused, consecutive row-wise stages in a single unit.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef FUSED_EZL_H
+#define FUSED_EZL_H
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ezl/pipeline/Link.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup units
+ * Sink for the output rows of a stage that passes them to the next units
+ * of a link, a single row or a batch of rows with a call to each.
+ * */
+template <class O>
+struct NextSink {
+  const Source<O>& src;
+  bool empty() const { return src.nextFlat().empty(); }
+  void operator()(const O& row) { src.toNext(row); }
+  void operator()(const std::vector<O>& rows) { src.toNext(rows); }
+};
+
+/*!
+ * @ingroup units
+ * A unit for the consecutive stages of Map and Filter units that are not
+ * separated by a parallel bridge or a branch. The output of a stage is
+ * passed to the next stage with a direct call that can be inlined, and
+ * only the output of the last stage is passed on to the next units. The
+ * column selections of the stages are all resolved at compile time.
+ *
+ * A stage is a type with `itype`, `otype` and `apply(row, sink)` for a row
+ * as well as a batch of rows, e.g. `MapStage`, `FilterStage`. The builders
+ * make the fused unit for map and filter expressions, see `fuseUnit`.
+ * */
+template <class... Ss>
+struct Fused : public Link<typename std::tuple_element<0, std::tuple<Ss...>>::type::itype,
+                           typename std::tuple_element<sizeof...(Ss) - 1,
+                               std::tuple<Ss...>>::type::otype> {
+public:
+  using stages = std::tuple<Ss...>;
+  using itype = typename std::tuple_element<0, stages>::type::itype;
+  using otype = typename std::tuple_element<sizeof...(Ss) - 1, stages>::type::otype;
+  static constexpr int osize = std::tuple_size<otype>::value;
+  static constexpr size_t nStages = sizeof...(Ss);
+
+  Fused(stages st) : _stages{std::move(st)} {}
+
+  virtual void dataEvent(const itype &data) final override {
+    NextSink<otype> out{*this};
+    _apply<0>(data, out);
+  }
+
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    NextSink<otype> out{*this};
+    _apply<0>(vData, out);
+  }
+
+  // stages of the unit, moved out when the unit is fused with the next stage.
+  stages& stagesRef() { return _stages; }
+
+  /*!
+   * the unit prior to this, kept for fusing the unit with a next stage.
+   * */
+  auto from() const { return _from.lock(); }
+
+  void from(const std::shared_ptr<Source<itype>>& pr) { _from = pr; }
+
+private:
+  // sink for the output of stage i that passes it to stage i + 1.
+  template <size_t i, class Out>
+  struct StageSink {
+    Fused* self;
+    Out& out;
+    bool empty() const { return false; }
+    template <class R> void operator()(const R& rows) {
+      self->template _apply<i + 1>(rows, out);
+    }
+  };
+
+  template <size_t i, class R, class Out>
+  void _apply(const R& rows, Out& out) {
+    _applyAt<i>(rows, out, std::integral_constant<bool, i + 1 == nStages>{});
+  }
+
+  template <size_t i, class R, class Out>
+  void _applyAt(const R& rows, Out& out, std::true_type) {
+    std::get<i>(_stages).apply(rows, out);
+  }
+
+  template <size_t i, class R, class Out>
+  void _applyAt(const R& rows, Out& out, std::false_type) {
+    StageSink<i, Out> sink{this, out};
+    std::get<i>(_stages).apply(rows, sink);
+  }
+
+  stages _stages;
+  std::weak_ptr<Source<itype>> _from;
+};
+
+/*!
+ * @ingroup units
+ * list of the types of stages that can be fused.
+ * */
+template <class... Ss> struct StageList {
+  static constexpr size_t size = sizeof...(Ss);
+};
+
+/*!
+ * @ingroup units
+ * The stages since the last unit that can not be fused, with `len` of them
+ * in the unit last built. Given by a map or filter builder to the builder
+ * of the next expression.
+ * */
+template <class R>
+struct FuseRun {
+  using type = R;
+  size_t len;
+};
+
+// maximum number of stages in a fused unit, a unit is made for the stages
+// of every suffix of the stage list that is kept, at compile time.
+constexpr size_t maxFused = 8;
+
+namespace meta {
+template <class R, class S> struct AppendStage;
+template <class... Ss, class S> struct AppendStage<StageList<Ss...>, S> {
+  using type = StageList<Ss..., S>;
+};
+
+// last k stages of a list
+template <class R, size_t k, class = void> struct LastStages;
+template <class S, class... Ss, size_t k>
+struct LastStages<StageList<S, Ss...>, k,
+                  std::enable_if_t<(sizeof...(Ss) + 1 > k)>> {
+  using type = typename LastStages<StageList<Ss...>, k>::type;
+};
+template <class... Ss, size_t k>
+struct LastStages<StageList<Ss...>, k,
+                  std::enable_if_t<sizeof...(Ss) == k>> {
+  using type = StageList<Ss...>;
+};
+
+template <class R> struct FusedType;
+template <class... Ss> struct FusedType<StageList<Ss...>> {
+  using type = Fused<Ss...>;
+};
+} // namespace meta
+
+// stages for the next unit after a unit with `len` last stages of `R, S`.
+template <class R, class S>
+auto nextFuseRun(size_t len) {
+  using NR = std::conditional_t<(R::size + 1 < maxFused),
+                                typename meta::AppendStage<R, S>::type,
+                                StageList<>>;
+  return FuseRun<NR>{(R::size + 1 < maxFused) ? len : 0};
+}
+
+// makes the unit of the stage, fused with the last `k` stages of `R` in the
+// prior unit if it is of these `k` stages.
+template <class R, size_t k> struct FuseAt {
+  template <class S>
+  static std::shared_ptr<Source<typename S::otype>>
+  make(const std::shared_ptr<Source<typename S::itype>>& pre, size_t len,
+       S&& stage, size_t& newLen) {
+    if (len != k) {
+      return FuseAt<R, k - 1>::make(pre, len, std::forward<S>(stage), newLen);
+    }
+    using Last = typename meta::LastStages<R, k>::type;
+    using Pre = typename meta::FusedType<Last>::type;
+    auto preUnit = std::static_pointer_cast<Pre>(pre);
+    auto from = preUnit->from();
+    if (!from || !preUnit->next().empty()) {
+      return FuseAt<R, 0>::make(pre, 0, std::forward<S>(stage), newLen);
+    }
+    from->unNext(preUnit.get());
+    using Cur = typename meta::FusedType<
+        typename meta::AppendStage<Last, std::decay_t<S>>::type>::type;
+    auto obj = std::make_shared<Cur>(std::tuple_cat(
+        std::move(preUnit->stagesRef()), std::make_tuple(std::forward<S>(stage))));
+    obj->from(from);
+    obj->prev(from, obj);
+    newLen = k + 1;
+    return obj;
+  }
+};
+
+template <class R> struct FuseAt<R, 0> {
+  template <class S>
+  static std::shared_ptr<Source<typename S::otype>>
+  make(const std::shared_ptr<Source<typename S::itype>>& pre, size_t,
+       S&& stage, size_t& newLen) {
+    auto obj = std::make_shared<Fused<std::decay_t<S>>>(
+        std::make_tuple(std::forward<S>(stage)));
+    obj->from(pre);
+    obj->prev(pre, obj);
+    newLen = 1;
+    return obj;
+  }
+};
+
+/*!
+ * @ingroup units
+ * Makes a unit of `stage` after the unit `pre`. If `pre` is a `Fused` unit
+ * of the last `len` stages of `R` with no other next unit, the stage is
+ * fused in a new unit with them that takes the place of `pre`.
+ * @param newLen sets the number of stages in the unit made.
+ * */
+template <class R, class S>
+auto fuseUnit(const std::shared_ptr<Source<typename S::itype>>& pre,
+              size_t len, S&& stage, size_t& newLen) {
+  if (len > R::size) len = 0;
+  return FuseAt<R, R::size>::make(pre, len, std::forward<S>(stage), newLen);
+}
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !FUSED_EZL_H
@@ -120,7 +120,7 @@ public:
     auto target = par.rank();
     if (par.nProc() == 1) {
       if (this->parHandle()->nProc() == 1 && this->par().inRange()) {
-        for (auto &it : this->next()) it.second->dataEvent(data);
+        this->toNext(data);
         return;
       }
       target = par[0];
@@ -152,7 +152,7 @@ public:
     }
     if (par.nProc() == 1) {
       if (this->parHandle()->nProc() == 1 && this->par().inRange()) {
-        for (auto &it : this->next()) it.second->dataEvent(vdata);
+        this->toNext(vdata);
         return;
       }
       std::move(std::begin(vdata), std::end(vdata),
@@ -223,7 +223,7 @@ private:
 
   void _sendrsInit() {
     if (!this->par().inRange()) return;
-    auto comm = Karta::inst().comm();
+    const auto &comm = Karta::inst().comm();
     for (auto it : *(this->parHandle())) {
       if (it == this->parHandle()->rank()) continue;
       if (_sendrs.find(it) == std::end(_sendrs)) {
@@ -271,9 +271,7 @@ private:
         auto hold = std::move(it->second.buf);
         *(req) = Karta::inst().comm().irecv(
             it->first, this->par().tag(1), it->second.buf);
-        for (auto &it : this->next()) {
-          it.second->dataEvent(hold);
-        }
+        this->toNext(hold);
       } while ((!maxIters || iters++ < maxIters) && req->test());
       break;
     case 1:
@@ -281,8 +279,8 @@ private:
         auto vhold = std::move(it->second.vBuf);
         *(req) = Karta::inst().comm().irecv(
             it->first, this->par().tag(2), it->second.vBuf);
-        for (auto &it : this->next()) {
-          for (auto &hold : vhold) it.second->dataEvent(hold);
+        for (auto nx : this->nextFlat()) {
+          for (auto &hold : vhold) nx->dataEvent(hold);
         }
         if (_debug && vhold.size() >= _every) {
           //std::cout << this->par().rank() << ", " << it->first << "- Vrecvd "
@@ -390,12 +388,10 @@ private:
     if (len == 0 && _recvrs[target].sentBuf.size() == 0) return false;
     if (target == this->parHandle()->rank()) {
       if (len == 1) {
-        for (auto &it : this->next()) {
-          it.second->dataEvent(_recvrs[target].buffer[0]);
-        }
+        this->toNext(_recvrs[target].buffer[0]);
       } else {
-        for (auto &it : this->next()) {
-          for (auto &val : _recvrs[target].buffer) it.second->dataEvent(val);
+        for (auto nx : this->nextFlat()) {
+          for (auto &val : _recvrs[target].buffer) nx->dataEvent(val);
         }
       }
       _recvrs[target].buffer.clear(); // TODO: needed?
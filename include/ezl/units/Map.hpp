@@ -13,9 +13,11 @@
 #define MAP_EZL_H
 
 #include <tuple>
+#include <vector>
 #include <type_traits>
 
 #include <ezl/pipeline/Link.hpp>
+#include <ezl/units/Fused.hpp>
 #include <ezl/helper/meta/funcInvoke.hpp>
 #include <ezl/helper/meta/slctTuple.hpp>
 #include <ezl/helper/meta/typeInfo.hpp>
@@ -23,6 +25,94 @@
 namespace ezl {
 namespace detail {
 
+/*!
+ * @ingroup units
+ * The transformation of a `Map` unit on a row or a batch of rows, that
+ * passes the output to a sink. It is the stage of a `Map` unit as well as
+ * of a `Fused` unit.
+ * */
+template <class Types>
+struct MapStage {
+public:
+  using itype = typename Types::I;
+  using otype = typename Types::otype;
+  using Func = typename Types::F;
+  using Fslct= typename Types::S;
+  using Oslct= typename Types::O;
+
+  MapStage(Func func) : _func(func) {}
+
+  /*!
+   * calls the UDF on the row and passes the output row(s) to `sink`, that
+   * takes a row or a vector of rows.
+   * */
+  template <class Sink>
+  void apply(const itype &data, Sink &sink) {
+    callEm<decltype(meta::invokeMap(_func, 
+      meta::slctTupleRef(data, Fslct{})))>(data, sink);
+  }
+
+  // the UDF is called for all the rows of a batch in a loop and the output
+  // rows are passed on as a batch.
+  template <class Sink>
+  void apply(const std::vector<itype> &vData, Sink &sink) {
+    using R = std::decay_t<decltype(meta::invokeMap(_func,
+        meta::slctTupleRef(std::declval<const itype&>(), Fslct{})))>;
+    std::vector<R> results;
+    results.reserve(vData.size());
+    for (const auto &data : vData) {
+      results.emplace_back(meta::invokeMap(_func,
+          meta::slctTupleRef(data, Fslct{})));
+    }
+    if (sink.empty()) return;
+    std::vector<otype> res;
+    res.reserve(vData.size());
+    for (size_t i = 0; i < vData.size(); ++i) {
+      addRows<R>(res, vData[i], results[i]);
+    }
+    if (res.empty()) return;
+    sink(res);
+  }
+
+private:
+  template <class T>
+  void addRows(std::vector<otype> &res, const itype &data, const T &result,
+      typename std::enable_if<meta::isVector<T>{}>::type* dummy = 0) {
+    for (const auto& it : result) {
+      res.emplace_back(meta::slctTupleRef(meta::tieTup(data, it), Oslct{}));
+    }
+  }
+
+  template <class T>
+  void addRows(std::vector<otype> &res, const itype &data, const T &result,
+      typename std::enable_if<!meta::isVector<T>{}>::type* dummy = 0) {
+    res.emplace_back(meta::slctTupleRef(meta::tieTup(data, result), Oslct{}));
+  }
+
+  template <class T, class Sink>
+  auto callEm(const itype &data, Sink &sink, typename std::enable_if<meta::isVector<T>{}>::type* dummy = 0) {
+    auto temp = meta::slctTupleRef(data, Fslct());
+    auto funOut = meta::invokeMap(_func, temp);
+    if (sink.empty()) return;
+    std::vector<otype> res;
+    res.reserve(funOut.size());
+    for (const auto& it : funOut) {
+      res.emplace_back(meta::slctTupleRef(meta::tieTup(data, it), Oslct{}));
+    }
+    sink(res);
+  }
+
+  template <class T, class Sink>
+  auto callEm(const itype &data, Sink &sink, typename std::enable_if<!meta::isVector<T>{}>::type* dummy = 0) {
+    auto temp = meta::slctTupleRef(data, Fslct());
+    auto result = meta::invokeMap(_func, temp);
+    if (sink.empty()) return;
+    sink(meta::slctTupleRef(meta::tieTup(data, result), Oslct{}));
+  }
+
+  Func _func;
+};
+
 /*!
  * @ingroup units
  * Map unit for transforming a row into zero, one or many new rows.
@@ -35,6 +125,9 @@ namespace detail {
  * A vector may be returned for returning variable number of rows for each
  * input row.
  *
+ * The builders make a `Fused` unit of `MapStage` instead, that can take in
+ * the next map and filter expressions.
+ *
  * See examples for using with builders or unittests for direct use.
  *
  * */
@@ -49,40 +142,20 @@ public:
   static constexpr int isize = std::tuple_size<itype>::value;
   static constexpr int osize = std::tuple_size<otype>::value;
 
-  Map(Func func) : _func(func) {}
+  Map(Func func) : _stage(func) {}
 
   virtual void dataEvent(const itype &data) final override {
-    callEm<decltype(meta::invokeMap(_func, 
-      meta::slctTupleRef(data, Fslct{})))>(data);
+    NextSink<otype> sink{*this};
+    _stage.apply(data, sink);
   }
-private:
-  template <class T>
-  auto callEm(const itype &data, typename std::enable_if<meta::isVector<T>{}>::type* dummy = 0) {
-    auto temp = meta::slctTupleRef(data, Fslct());
-    auto funOut = meta::invokeMap(_func, temp);
-    if (Link<itype, otype>::next().empty()) return;
-    std::vector<otype> res;
-    res.reserve(funOut.size());
-    for (const auto& it : funOut) {
-      res.emplace_back(meta::slctTupleRef(meta::tieTup(data, it), Oslct{}));
-     }
-     for (auto &it : Link<itype, otype>::next()) {
-       it.second->dataEvent(res);
-     }
-   }
 
-  template <class T>
-  auto callEm(const itype &data, typename std::enable_if<!meta::isVector<T>{}>::type* dummy = 0) {
-    auto temp = meta::slctTupleRef(data, Fslct());
-    auto result = meta::invokeMap(_func, temp);
-    if (Link<itype, otype>::next().empty()) return;
-    auto otemp = meta::slctTupleRef(meta::tieTup(data, result), Oslct{});
-    for (auto &it : Link<itype, otype>::next()) {
-      it.second->dataEvent(otemp);
-    }
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    NextSink<otype> sink{*this};
+    _stage.apply(vData, sink);
   }
 
-  Func _func;
+private:
+  MapStage<Types> _stage;
 };
 }
 } // namespace ezl ezl::detail
@@ -35,10 +35,10 @@ public:
   using otype = IO;
   static constexpr int osize = std::tuple_size<otype>::value;
   virtual void dataEvent(const itype &data) final override {
-    for (auto &it : this->next()) it.second->dataEvent(data);
+    this->toNext(data);
   }
   virtual void dataEvent(const std::vector<itype> &vData) final override {
-    for (auto &it : this->next()) it.second->dataEvent(vData);
+    this->toNext(vData);
   };
 };
 }
@@ -0,0 +1,225 @@
+/*!
+ * @file
+ * class QueueBridge, unit for parallelism of ranks that run as threads
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#if !defined QUEUEBRIDGE_EZL_H && defined NOMPI
+#define QUEUEBRIDGE_EZL_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <ezl/pipeline/Bridge.hpp>
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/meta/slctTuple.hpp>
+#include <ezl/helper/meta/funcInvoke.hpp>
+#include <ezl/helper/Par.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup units
+ * A pipeline link for task and data parallelism with NOMPI, when the ranks
+ * run as threads of a process with `runRanks`. It sends the rows to the
+ * ranks of the next task like `MPIBridge`, with the same partitioning on
+ * the key columns, `toAll` and round-robin, but the rows of a rank are
+ * batched in a vector that is queued for the receiving rank in memory,
+ * see `ThreadHub`.
+ *
+ * As the rows are sent the rank passes on the batches that it has received
+ * so far, and at the end of data it sends a signal to each of the receiving
+ * ranks and waits for the batches of all the sending ranks till their
+ * signal. The rows for the rank itself are passed on without queueing. If
+ * the receiving rank is behind by `maxQueued` batches the sending rank
+ * waits for it, receiving its own batches in the meantime. As with
+ * `MPIBridge`, this may result in a deadlock in specific pipelines.
+ *
+ * If `ordered`, a batch is sent only when the key of the rows changes, so
+ * that the rows of a key reach the receiving rank together.
+ *
+ * This is added to the pipeline in place of `MPIBridge` when a unit
+ * specifies `prll` property with NOMPI. With a single rank it passes the
+ * rows on as they are.
+ * */
+template <class IO, class Kslct, class Partitioner>
+struct QueueBridge : public Bridge<IO> {
+public:
+  using itype = IO;
+  using otype = IO;
+  using buftype = typename meta::SlctTupleType<IO>::type;
+  static constexpr int osize = std::tuple_size<otype>::value;
+  using ktype = typename meta::SlctTupleType<buftype, Kslct>::type;
+
+  static constexpr size_t batchRows = 1 << 10;
+  static constexpr size_t maxQueued = 1 << 10;
+
+private:
+  // struct for keeping record of each receiver
+  struct Receiver {
+    std::vector<buftype> buffer;
+    bool isFirst{true};
+    ktype preKey;
+  };
+
+public:
+  QueueBridge(ProcReq r, bool toAll, bool ordered, Partitioner p, Task* bro)
+      : Bridge<IO>{r, bro}, _toAll{toAll}, _ordered{ordered}, _partitioner{p} {}
+
+  virtual void dataEvent(const itype &data) final override {
+    if (!this->parHandle() || !this->parHandle()->inRange()) return;
+    const auto &par = this->par();
+    if (_toAll) {
+      for (const auto &it : par) _add(it, data);
+      return;
+    }
+    if (par.nProc() == 1) {
+      if (this->parHandle()->nProc() == 1 && par.inRange()) {
+        this->toNext(data);
+        return;
+      }
+      _add(par[0], data);
+    } else {
+      _add(_target(data), data);
+    }
+  }
+
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    if (vData.empty()) return;
+    if (!this->parHandle() || !this->parHandle()->inRange()) return;
+    const auto &par = this->par();
+    if (!_toAll && par.nProc() == 1 && this->parHandle()->nProc() == 1 &&
+        par.inRange()) {
+      this->toNext(vData);
+      return;
+    }
+    for (const auto &it : vData) dataEvent(it);
+  }
+
+private:
+  virtual void _dataBegin() override final {
+    meta::invokeFallBack(_partitioner, this->par().pos(), this->par().procAll());
+    _rank = this->par().rank();
+    _tag = this->par().tag(2);
+    if (this->parHandle()->inRange()) {
+      for (const auto &it : this->par()) {
+        if (it != _rank && _recvrs.find(it) == std::end(_recvrs)) {
+          _recvrs[it] = Receiver();
+        }
+      }
+    }
+    if (this->par().inRange()) {
+      for (auto it : *(this->parHandle())) {
+        if (it != _rank) _sendrs.insert(it);
+      }
+    }
+  }
+
+  virtual void _dataEnd(int) override final {
+    if (!this->par().inRange() && !this->parHandle()->inRange()) return;
+    const auto &comm = Karta::inst().comm();
+    for (auto &it : _recvrs) {
+      _send(it.first);
+      comm.send(it.first, _tag);  // signal
+    }
+    while (!_sendrs.empty()) _recvAll(true);
+    _curRoll = 0;
+    _recvrs.clear();
+    _sendrs.clear();
+  }
+
+  int _target(const itype &data) {
+    const auto &par = this->par();
+    if (std::tuple_size<ktype>::value == 0) {
+      auto target = par[_curRoll];
+      _curRoll = (_curRoll + 1) % par.nProc();
+      return target;
+    }
+    auto key = meta::slctTupleRef(data, Kslct{});
+    return par[(_partitioner(key)) % par.nProc()];
+  }
+
+  void _add(int target, const itype &data) {
+    if (target == _rank) {
+      this->toNext(data);
+      return;
+    }
+    auto &recvr = _recvrs[target];
+    if (_ordered && std::tuple_size<ktype>::value > 0) {
+      ktype key = meta::slctTupleRef(data, Kslct{});
+      if (!recvr.isFirst && !(key == recvr.preKey) &&
+          recvr.buffer.size() >= batchRows) {
+        _send(target);
+      }
+      recvr.isFirst = false;
+      recvr.preKey = std::move(key);
+      recvr.buffer.emplace_back(data);
+      return;
+    }
+    recvr.buffer.emplace_back(data);
+    if (recvr.buffer.size() >= batchRows) _send(target);
+  }
+
+  // queues the buffer of the target, waits while it is behind.
+  void _send(int target) {
+    auto &buffer = _recvrs[target].buffer;
+    if (buffer.empty()) return;
+    const auto &comm = Karta::inst().comm();
+    comm.send(target, _tag,
+              std::make_shared<std::vector<buftype>>(std::move(buffer)));
+    buffer = std::vector<buftype>{};
+    buffer.reserve(batchRows);
+    _recvAll();
+    while (comm.queued(target, _tag) >= maxQueued) {
+      if (!_recvAll()) std::this_thread::yield();
+    }
+  }
+
+  // passes on the batches received, returns false if there is none.
+  bool _recvAll(bool wait = false) {
+    if (_sendrs.empty()) return false;
+    const auto &comm = Karta::inst().comm();
+    auto res = false;
+    int src = -1;
+    std::shared_ptr<void> msg;
+    while (!_sendrs.empty() && comm.recv(src, _tag, msg, wait)) {
+      res = true;
+      wait = false;
+      if (!msg) {
+        _sendrs.erase(src);
+      } else {
+        const auto &rows = *std::static_pointer_cast<std::vector<buftype>>(msg);
+        std::vector<itype> refs;
+        refs.reserve(rows.size());
+        for (const auto &it : rows) refs.emplace_back(it);
+        this->toNext(refs);
+      }
+      src = -1;
+      msg.reset();
+    }
+    return res;
+  }
+
+  const bool _toAll;
+  const bool _ordered;
+  Partitioner _partitioner;
+  int _rank{0};
+  int _tag{0};
+  int _curRoll{0};
+  std::map<int, Receiver> _recvrs; // on right, to which data is to be sent
+  std::set<int> _sendrs;           // on left, from which data is received
+};
+}
+} // namespace ezl ezl::detail
+
+#endif // !QUEUEBRIDGE_EZL_H
@@ -120,9 +120,7 @@ private:
         res.emplace_back(meta::slctTupleRef(meta::tieTup(it.first, jt) , Oslct{}));
       }
     }
-    for (auto &jt : Link<itype, otype>::next()) {
-      jt.second->dataEvent(res);
-    }
+    Link<itype, otype>::toNext(res);
   }
 
   template <class T>
@@ -134,17 +132,13 @@ private:
           meta::slctTupleRef(meta::tieTup(it.first, it.second) , Oslct{})
       );
     }
-    for (auto &jt : Link<itype, otype>::next()) {
-      jt.second->dataEvent(res);
-    }
+    Link<itype, otype>::toNext(res);
   }
 
   template <class T>
   auto callKey(typename maptype::iterator it, typename std::enable_if<!meta::isVector<T>{}>::type* dummy = 0) {
     auto x = meta::slctTupleRef(meta::tieTup(it->first, it->second), Oslct{});
-    for (auto &jt : Link<itype, otype>::next()) {
-      jt.second->dataEvent(x);
-    }
+    Link<itype, otype>::toNext(x);
   }
 
   template <class T>
@@ -154,9 +148,7 @@ private:
     for(const auto& jt : it->second) {
       res.push_back(meta::slctTupleRef(meta::tieTup(it->first, jt), Oslct{}));
     }
-    for (auto &jt : Link<itype, otype>::next()) {
-      jt.second->dataEvent(res);
-    }
+    Link<itype, otype>::toNext(res);
   }
 private:
   F _func;
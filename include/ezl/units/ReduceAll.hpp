@@ -114,9 +114,7 @@ private:
     for (auto &it : funOut) {
       res.emplace_back(meta::slctTupleRef(meta::tieTup(key, it), _oslct));
     }
-    for (auto &it : Link<itype, otype>::next()) {
-      it.second->dataEvent(res);
-    }
+    Link<itype, otype>::toNext(res);
   }
   
   template <class T>
@@ -124,9 +122,7 @@ private:
     auto funOut = meta::invokeReduceAll(_func, key, buffer);
     if (Link<itype, otype>::next().empty()) return;
     auto result = meta::slctTupleRef(meta::tieTup(key, funOut), _oslct);
-    for (auto &it : Link<itype, otype>::next()) {
-      it.second->dataEvent(result);
-    }
+    Link<itype, otype>::toNext(result);
   }
 
   bool _processBunched(const typename maptype::iterator& it) {
@@ -17,6 +17,7 @@
 #include <functional>
 
 #include <ezl/pipeline/Root.hpp>
+#include <ezl/helper/RowRange.hpp>
 #include <ezl/helper/meta/typeInfo.hpp>
 
 namespace ezl {
@@ -32,6 +33,9 @@ namespace detail {
  *
  * For single row at a time, a pair/tuple of (row, 'is end of data) is to be
  * returned. For a vector return type, an empty vector represents 'end of data'.
+ * A `RowRange` over rows kept by the UDF can be returned in place of a vector
+ * to avoid copying them. The rows of a vector or range are passed to the
+ * next units as a batch, with a single call to each.
  *
  * A variant once introduced in standard will be better suited than the pair
  * with a flag. :(
@@ -70,33 +74,37 @@ private:
   }
 
   template <class T>
-  auto callEm(typename std::enable_if<!meta::isVector<T>{}>::type*
+  using isBatch = std::integral_constant<bool, meta::isVector<T>{} ||
+                                                   meta::isRowRange<T>{}>;
+
+  template <class T>
+  auto callEm(typename std::enable_if<!isBatch<T>{}>::type*
       dummy = 0) {
     decltype(auto) res = _func();
     if (!std::get<1>(res)) return false;
     auto rowRef = meta::tieTup(std::get<0>(res));
-    for (auto &it : this->next()) {
-      it.second->dataEvent(rowRef);
-    }
+    this->toNext(rowRef);
     return true;
   }
 
+  // the rows are passed on as a batch with a single call for each next unit.
   template <class T>
-  auto callEm(typename std::enable_if<meta::isVector<T>{}>::type*
+  auto callEm(typename std::enable_if<isBatch<T>{}>::type*
       dummy = 0) {
     decltype(auto) rows = _func();
     if (rows.empty()) {
       return false;
     }
+    _batch.clear();
     for (auto &row : rows) {
-      for (auto &it : this->next()) {
-        it.second->dataEvent(meta::tieTup(row));
-      }
+      _batch.emplace_back(meta::tieTup(row));
     }
+    this->toNext(_batch);
     return true;
   }
 
   F _func;
+  std::vector<otype> _batch;
   bool _share {false};
   std::pair<int, std::vector<int>>* _procSink;
 };
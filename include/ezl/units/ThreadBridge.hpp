@@ -0,0 +1,309 @@
+/*!
+ * @file
+ * class ThreadBridge and ThreadJoin, units for parallelism with threads in a
+ * process.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#ifndef THREADBRIDGE_EZL_H
+#define THREADBRIDGE_EZL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <ezl/pipeline/Link.hpp>
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/Par.hpp>
+#include <ezl/helper/meta/funcInvoke.hpp>
+#include <ezl/helper/meta/slctTuple.hpp>
+
+namespace ezl {
+namespace detail {
+
+/*!
+ * @ingroup units
+ * The part of `ThreadJoin` that `ThreadBridge` calls to pass on the rows
+ * that the threads have given so far.
+ * */
+struct ThreadDrain {
+  virtual ~ThreadDrain() {}
+  virtual void drain() = 0;
+};
+
+/*!
+ * @ingroup units
+ * Takes the output rows of the copies of a unit that run on the threads of
+ * a `ThreadBridge` and passes them to the next units on the thread of the
+ * dataflow, in batches. The rows are copied in a buffer as they come from
+ * the threads, and are passed on when the bridge calls `drain` or at the end
+ * of data. Hence the units after it need not be thread safe, including a
+ * `MPIBridge`.
+ *
+ * The order of rows from different threads is not kept.
+ * */
+template <class IO>
+struct ThreadJoin : public Link<IO, IO>, public ThreadDrain {
+public:
+  using itype = IO;
+  using otype = IO;
+  using buftype = typename meta::SlctTupleType<IO>::type;
+  static constexpr int osize = std::tuple_size<otype>::value;
+
+  virtual void dataEvent(const itype &data) final override {
+    if (this->nextFlat().empty()) return;
+    std::lock_guard<std::mutex> lock{_mut};
+    _rows.emplace_back(data);
+  }
+
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    if (this->nextFlat().empty()) return;
+    std::lock_guard<std::mutex> lock{_mut};
+    _rows.insert(std::end(_rows), std::begin(vData), std::end(vData));
+  }
+
+  virtual void drain() final override {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      if (_rows.empty()) return;
+      _out.swap(_rows);
+    }
+    _batch.clear();
+    _batch.reserve(_out.size());
+    for (const auto &it : _out) _batch.emplace_back(it);
+    this->toNext(_batch);
+    _batch.clear();
+    _out.clear();
+  }
+
+private:
+  virtual void _dataEnd(int) final override { drain(); }
+
+  std::mutex _mut;
+  std::vector<buftype> _rows;
+  std::vector<buftype> _out;
+  std::vector<otype> _batch;
+};
+
+/*!
+ * @ingroup units
+ * A pipeline link for parallelism with threads in a process. The next units
+ * are the copies of a unit, one for each thread, while the output of the
+ * copies is passed on by a `ThreadJoin`.
+ *
+ * The rows are partitioned on the key columns `Kslct` with `Partitioner`
+ * like in `MPIBridge`, so that the rows of a key go to the same thread. The
+ * rows that a process gets from a `MPIBridge` before it are the ones with
+ * the same partition value modulo number of processes, so the threads take
+ * the partition value divided by the number of processes, modulo number of
+ * threads. Without key columns the batches of rows go to the threads in
+ * turns, or to all the threads if `toAll`.
+ *
+ * The rows are copied in a batch for each thread, and a full batch is
+ * queued for the thread, which calls its unit with it. The threads are
+ * started with the first rows and are done at the end of data, before the
+ * signal reaches the copies of the unit. An exception in a thread is
+ * rethrown with the next rows or at the end of data.
+ *
+ * This is added to the pipeline when a unit specifies `prll(threads(n))`.
+ * `PrllExpr` has the builder expression. The UDF of the unit is copied for
+ * each thread and is called from the threads at the same time.
+ * */
+template <class IO, class Kslct, class Partitioner>
+struct ThreadBridge : public Link<IO, IO> {
+public:
+  using itype = IO;
+  using otype = IO;
+  using buftype = typename meta::SlctTupleType<IO>::type;
+  static constexpr int osize = std::tuple_size<otype>::value;
+  using ktype = typename meta::SlctTupleType<buftype, Kslct>::type;
+
+  ThreadBridge(size_t nThreads, bool toAll, Partitioner p,
+               size_t batchRows = 1024, size_t depth = 4)
+      : _nThreads{nThreads ? nThreads : 1}, _toAll{toAll}, _partitioner{p},
+        _batchRows{batchRows ? batchRows : 1}, _depth{depth ? depth : 1} {}
+
+  ~ThreadBridge() { _stop(); }
+
+  // sets the unit that passes on the output of the threads.
+  void join(ThreadDrain *j) { _join = j; }
+
+  virtual void dataEvent(const itype &data) final override {
+    if (this->nextFlat().empty()) return;
+    if (_lanes.empty()) _start();
+    if (_toAll) {
+      for (size_t i = 0; i < _lanes.size(); ++i) _add(i, data);
+    } else {
+      _add(_laneOf(data), data);
+    }
+  }
+
+  virtual void dataEvent(const std::vector<itype> &vData) final override {
+    if (vData.empty() || this->nextFlat().empty()) return;
+    if (_lanes.empty()) _start();
+    for (const auto &it : vData) {
+      if (_toAll) {
+        for (size_t i = 0; i < _lanes.size(); ++i) _add(i, it);
+      } else {
+        _add(_laneOf(it), it);
+      }
+    }
+  }
+
+private:
+  // rows for a thread and its unit.
+  struct Lane {
+    std::vector<buftype> cur;
+    std::deque<std::vector<buftype>> q;
+    Dest<IO> *unit{nullptr};
+  };
+
+  virtual void _dataBegin(const Par *pr) final override {
+    _nProc = (pr && pr->nProc() > 0) ? pr->nProc() : 1;
+    if (pr) meta::invokeFallBack(_partitioner, pr->pos(), pr->procAll());
+  }
+
+  virtual void _dataEnd(int) final override {
+    if (_lanes.empty()) return;
+    for (size_t i = 0; i < _lanes.size(); ++i) _push(i);
+    _stop();
+    if (_join) _join->drain();
+    _rethrow();
+  }
+
+  size_t _laneOf(const itype &data) {
+    if (std::tuple_size<ktype>::value == 0) return _curRoll;
+    auto key = meta::slctTupleRef(data, Kslct{});
+    return size_t(_partitioner(key) / _nProc) % _lanes.size();
+  }
+
+  template <class T>
+  void _add(size_t i, const T &row) {
+    auto &cur = _lanes[i].cur;
+    cur.emplace_back(row);
+    if (cur.size() < _batchRows) return;
+    _push(i);
+    if (std::tuple_size<ktype>::value == 0) {
+      _curRoll = (_curRoll + 1) % _lanes.size();
+    }
+    if (_join) _join->drain();
+    _rethrow();
+  }
+
+  // queues the batch of the thread, waits if the thread is behind.
+  void _push(size_t i) {
+    auto &lane = _lanes[i];
+    if (lane.cur.empty()) return;
+    {
+      std::unique_lock<std::mutex> lock{_mut};
+      _pushCv.wait(lock, [this, &lane] {
+        return _error || lane.q.size() < _depth;
+      });
+      lane.q.push_back(std::move(lane.cur));
+    }
+    lane.cur = std::vector<buftype>{};
+    lane.cur.reserve(_batchRows);
+    _popCv.notify_all();
+  }
+
+  void _start() {
+    const auto &next = this->nextFlat();
+    auto n = std::min(_nThreads, next.size());
+    _lanes = std::vector<Lane>(n);
+    _done = false;
+    _error = nullptr;
+    _curRoll = 0;
+    // the threads work for the rank of the flow.
+    auto rank = Karta::rankOf();
+    for (size_t i = 0; i < n; ++i) {
+      _lanes[i].unit = next[i];
+      _lanes[i].cur.reserve(_batchRows);
+      _threads.emplace_back([this, i, rank] {
+        Karta::actAs(rank);
+        _run(i);
+      });
+    }
+  }
+
+  // waits for the threads to finish the queued batches.
+  void _stop() {
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      _done = true;
+    }
+    _popCv.notify_all();
+    for (auto &it : _threads) it.join();
+    _threads.clear();
+    _lanes.clear();
+  }
+
+  void _rethrow() {
+    std::exception_ptr err;
+    {
+      std::lock_guard<std::mutex> lock{_mut};
+      err = _error;
+      _error = nullptr;
+    }
+    if (err) {
+      _stop();
+      std::rethrow_exception(err);
+    }
+  }
+
+  void _run(size_t i) {
+    auto &lane = _lanes[i];
+    std::vector<buftype> rows;
+    std::vector<itype> refs;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock{_mut};
+        _popCv.wait(lock, [this, &lane] { return _done || !lane.q.empty(); });
+        if (lane.q.empty()) return;
+        rows = std::move(lane.q.front());
+        lane.q.pop_front();
+      }
+      _pushCv.notify_all();
+      refs.clear();
+      refs.reserve(rows.size());
+      for (const auto &it : rows) refs.emplace_back(it);
+      try {
+        lane.unit->dataEvent(refs);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock{_mut};
+        if (!_error) _error = std::current_exception();
+        for (auto &it : _lanes) it.q.clear();
+        _pushCv.notify_all();
+      }
+    }
+  }
+
+  size_t _nThreads;
+  bool _toAll;
+  Partitioner _partitioner;
+  size_t _batchRows;
+  size_t _depth;
+  int _nProc{1};
+  size_t _curRoll{0};
+  ThreadDrain *_join{nullptr};
+  std::vector<Lane> _lanes;
+  std::vector<std::thread> _threads;
+  std::mutex _mut;
+  std::condition_variable _popCv;
+  std::condition_variable _pushCv;
+  std::exception_ptr _error{nullptr};
+  bool _done{false};
+};
+
+} // namespace detail
+} // namespace ezl
+
+#endif // !THREADBRIDGE_EZL_H
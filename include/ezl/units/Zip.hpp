@@ -201,9 +201,7 @@ private:
           meta::slctTupleRef(meta::tieTup(it1->second.front(),
                                           it2->second.front()),
                              Oslct{});
-      for (auto &it : Source<otype>::next()) {
-        it.second->dataEvent(otemp);
-      }
+      Source<otype>::toNext(otemp);
       it1->second.pop_front();
       it2->second.pop_front();
     }
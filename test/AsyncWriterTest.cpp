@@ -0,0 +1,136 @@
+/*!
+ * @file
+ * Basic tests for `AsyncWriter.hpp`
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <assert.h>
+
+#include <ezl/helper/AsyncWriter.hpp>
+#include <ezl/helper/TextBuffer.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void asyncWriterOrderTest();
+void asyncWriterFullTest();
+void asyncWriterFailTest();
+
+void AsyncWriterTest(int argc, char* argv[]) {
+  asyncWriterOrderTest();
+  asyncWriterFullTest();
+  asyncWriterFailTest();
+}
+
+// stream buffer that holds the writer thread in a write till it is opened.
+struct GateBuf : public std::streambuf {
+  void open() {
+    {
+      std::lock_guard<std::mutex> lock{mut};
+      isOpen = true;
+    }
+    cv.notify_all();
+  }
+
+  void waitEntered() {
+    std::unique_lock<std::mutex> lock{mut};
+    cv.wait(lock, [this] { return isEntered; });
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    std::unique_lock<std::mutex> lock{mut};
+    isEntered = true;
+    cv.notify_all();
+    cv.wait(lock, [this] { return isOpen; });
+    out.append(s, size_t(n));
+    return n;
+  }
+
+  std::mutex mut;
+  std::condition_variable cv;
+  bool isOpen{false};
+  bool isEntered{false};
+  std::string out;
+};
+
+void asyncWriterOrderTest() {
+  AsyncWriter w{2};
+  std::ostringstream os;
+  std::string expected;
+  TextBuffer buf;
+  for (auto i = 0; i < 100; ++i) {
+    buf.put(i);
+    buf.put('\n');
+    expected += std::to_string(i) + "\n";
+    w.write(os, buf);
+    assert(buf.size() == 0);
+  }
+  assert(w.finish());
+  assert(os.str() == expected);
+}
+
+void asyncWriterFullTest() {
+  // one buffer being written and `depth` waiting, the next write waits.
+  AsyncWriter w{2};
+  GateBuf gate;
+  std::ostream os{&gate};
+  TextBuffer buf;
+  buf.put("a");
+  w.write(os, buf);
+  gate.waitEntered();
+  buf.put("b");
+  w.write(os, buf);
+  buf.put("c");
+  w.write(os, buf);
+  std::atomic<bool> isWritten{false};
+  std::thread t{[&w, &os, &isWritten] {
+    TextBuffer last;
+    last.put("d");
+    w.write(os, last);
+    isWritten = true;
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!isWritten);
+  gate.open();
+  t.join();
+  assert(isWritten);
+  assert(w.finish());
+  assert(gate.out == "abcd");
+}
+
+void asyncWriterFailTest() {
+  AsyncWriter w;
+  std::ostream bad{nullptr};  // every write fails
+  TextBuffer buf;
+  buf.put("lost");
+  w.write(bad, buf);
+  assert(!w.finish());
+
+  // the writer starts again after finish, without the earlier failure.
+  std::ostringstream os;
+  buf.put("first");
+  w.write(os, buf);
+  assert(w.finish());
+  buf.put("second");
+  w.write(os, buf);
+  assert(w.finish());
+  assert(os.str() == "firstsecond");
+  assert(w.finish());  // nothing written
+}
+}
+}
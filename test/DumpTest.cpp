@@ -0,0 +1,132 @@
+/*!
+ * @file
+ * Basic tests for `Dump.hpp` and `TextBuffer.hpp`
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <assert.h>
+
+#include <ezl/helper/Karta.hpp>
+#include <ezl/helper/Par.hpp>
+#include <ezl/helper/TextBuffer.hpp>
+#include <ezl/pipeline/Source.hpp>
+#include <ezl/units/Dump.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void textBufferTest();
+void dumpFileTest();
+
+void DumpTest(int argc, char* argv[]) {
+  textBufferTest();
+  dumpFileTest();
+}
+
+// the text of a row with the default format is same as with the stream.
+template <class Row>
+void sameAsStream(const Row& row) {
+  std::ostringstream ss;
+  ss << row << '\n';
+  TextBuffer buf;
+  buf.row(row, TextFormat{});
+  assert(std::string(buf.data(), buf.size()) == ss.str());
+}
+
+void textBufferTest() {
+  using std::array;
+  using std::make_tuple;
+  using std::string;
+  using std::vector;
+  sameAsStream(make_tuple(0, -1, 42L, 1234567890123LL, 7U,
+                          std::numeric_limits<long long>::min(),
+                          std::numeric_limits<unsigned long>::max()));
+  sameAsStream(make_tuple(0.F, 2.5, -1.51998F, 1e-7, 123456789.0, 1e300,
+                          0.1 + 0.2, -0.0, 3.0L));
+  sameAsStream(make_tuple(std::numeric_limits<double>::infinity(),
+                          std::numeric_limits<double>::quiet_NaN()));
+  sameAsStream(make_tuple('a', true, false, string("abc"), string(""), "xyz"));
+  sameAsStream(make_tuple(array<float, 3>{{1.F, 2.5F, -3.F}},
+                          vector<int>{1, 2, 3}, vector<string>{},
+                          std::make_pair(1, string("b")),
+                          make_tuple(1, make_tuple(2.5, 'c'))));
+  sameAsStream(make_tuple(vector<array<int, 2>>{{{1, 2}}, {{3, 4}}}));
+
+  TextBuffer buf;
+  auto fmt = TextFormat{"", "\t", "", ";"};
+  buf.row(make_tuple(1, 2.5, string("x")), fmt);
+  buf.row(make_tuple(-3, 0.125, string("yy")), fmt);
+  assert(string(buf.data(), buf.size()) == "1\t2.5\tx;-3\t0.125\tyy;");
+  buf.clear();
+  assert(buf.size() == 0);
+  buf.row(make_tuple(7), TextFormat{"<", ",", ">", "\n"});
+  assert(string(buf.data(), buf.size()) == "<7>\n");
+}
+
+void dumpFileTest() {
+  using std::string;
+  using std::tuple;
+  using Row = tuple<int, float, string>;
+  // a file for each rank as the ranks run the tests at the same time
+  const auto rank = std::to_string(Karta::inst().rank());
+  const string fname = "dumpTest" + rank + ".txt";
+  std::remove(fname.c_str());
+  // buffer smaller than the rows written to check flushing in between
+  Dump<Row> d{fname, "id,val,name", TextFormat{"", ",", "", "\n"}, 64};
+  auto pr = Par{std::vector<int>{0}, std::array<int, 3>{{1,2,3}}, 0};
+  d.forwardPar(&pr);
+  std::ostringstream expected;
+  expected << "id,val,name\n";
+  for (auto i = 0; i < 100; ++i) {
+    auto row = Row{i, i * 0.5F, string(i % 5, 'a')};
+    d.dataEvent(row);
+    expected << std::get<0>(row) << ',' << std::get<1>(row) << ','
+             << std::get<2>(row) << '\n';
+  }
+  d.signalEvent(1);
+  std::ifstream in(fname);
+  std::stringstream written;
+  written << in.rdbuf();
+  assert(written.str() == expected.str());
+
+  // shared file is appended to at the end of data
+  Dump<Row> shared{fname, "", TextFormat{"", ",", "", "\n"}, 64, true};
+  shared.forwardPar(&pr);
+  shared.dataEvent(Row{1, 2.5F, "b"});
+  shared.signalEvent(1);
+  std::ifstream in2(fname);
+  std::stringstream appended;
+  appended << in2.rdbuf();
+  assert(appended.str() == expected.str() + "1,2.5,b\n");
+
+  // rows of a shared dump beyond the buffer are kept in a file till the end
+  Dump<Row> spilled{fname, "", TextFormat{"", ",", "", "\n"}, 64, true};
+  spilled.forwardPar(&pr);
+  for (auto i = 0; i < 100; ++i) spilled.dataEvent(Row{i, 0.5F, "c"});
+  spilled.signalEvent(1);
+  std::ostringstream rest;
+  for (auto i = 0; i < 100; ++i) rest << i << ",0.5,c\n";
+  std::ifstream in3(fname);
+  std::stringstream appended2;
+  appended2 << in3.rdbuf();
+  assert(appended2.str() == appended.str() + rest.str());
+  assert(!std::ifstream(fname + ".0.part").good());
+  std::remove(fname.c_str());
+}
+}
+}
@@ -11,6 +11,7 @@
  * */
 
 #include <tuple>
+#include <vector>
 #include <assert.h>
 
 #include <ezl/units/Filter.hpp>
@@ -20,9 +21,11 @@ namespace test {
 using namespace ezl::detail;
 
 void FilterBasicCallTest();
+void FilterBatchTest();
 
 void FilterTest(int argc, char* argv[]) {
   FilterBasicCallTest();
+  FilterBatchTest();
 }
 
 void FilterBasicCallTest() {
@@ -40,5 +43,32 @@ void FilterBasicCallTest() {
   r1.dataEvent(t1);
   assert(ch == 'c');
 }
+// the selected rows of a batch are passed on in a single batch.
+void FilterBatchTest() {
+  using meta::slct;
+  using std::tuple;
+  using std::vector;
+
+  auto count = 0;
+  auto sum = 0;
+  auto sink = [&count, &sum](int i) {
+    ++count;
+    sum += i;
+    return false;
+  };
+  using otype = tuple<const int&>;
+  auto rec = std::make_shared<Filter<otype, slct<1>, decltype(sink), slct<1>>>(sink);
+  auto odd = [](int i) { return i % 2 == 1; };
+  auto f1 = std::make_shared<Filter<tuple<int, char>, slct<1>, decltype(odd), slct<1>>>(odd);
+  f1->next(rec, f1);
+  vector<tuple<int, char>> rows;
+  for (auto i = 0; i < 10; ++i) rows.emplace_back(i, 'a');
+  f1->dataEvent(rows);
+  assert(count == 5);
+  assert(sum == 1 + 3 + 5 + 7 + 9);
+  count = 0;
+  f1->dataEvent(vector<tuple<int, char>>{tuple<int, char>{2, 'b'}});
+  assert(count == 0);
+}
 }
 }
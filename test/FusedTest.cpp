@@ -0,0 +1,153 @@
+/*!
+ * @file
+ * Basic tests for `Fused.hpp` and fusing of map and filter units in a
+ * dataflow.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/units/Filter.hpp>
+#include <ezl/units/Fused.hpp>
+#include <ezl/units/Map.hpp>
+#include <ezl/units/NoOp.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void FusedBasicCallTest();
+void FusedBuilderTest();
+
+void FusedTest(int argc, char* argv[]) {
+  FusedBasicCallTest();
+  FusedBuilderTest();
+}
+
+void FusedBasicCallTest() {
+  using std::tuple;
+  using std::vector;
+  using meta::slct;
+  using meta::MapTypes;
+
+  auto twice = [](int i) { return i * 2; };
+  auto isBig = [](int j) { return j > 4; };
+  auto split = [](int i, int j) { return vector<int>{i, j}; };
+  using I = tuple<const int&>;
+  using M1 = MapStage<MapTypes<I, slct<1>, decltype(twice), slct<1, 2>>>;
+  using I2 = M1::otype;
+  using F1 = FilterStage<I2, slct<2>, decltype(isBig), slct<1, 2>>;
+  using M2 = MapStage<MapTypes<I2, slct<1, 2>, decltype(split), slct<2, 3>>>;
+  auto fused = std::make_shared<Fused<M1, F1, M2>>(
+      std::make_tuple(M1{twice}, F1{isBig}, M2{split}));
+  static_assert(std::is_same<Fused<M1, F1, M2>::otype, M2::otype>::value, "");
+
+  auto count = 0;
+  auto sum = 0;
+  auto sink = [&count, &sum](int j, int k) {
+    ++count;
+    sum += j * k;
+    return false;
+  };
+  using O = M2::otype;
+  auto dumpfl =
+      std::make_shared<Filter<O, slct<1, 2>, decltype(sink), slct<1, 2>>>(sink);
+  // with no next unit the stages are still called with no output.
+  for (int i = 0; i < 5; ++i) fused->dataEvent(I{i});
+  fused->next(dumpfl, fused);
+  for (int i = 0; i < 5; ++i) fused->dataEvent(I{i});
+  assert(count == 4);
+  assert(sum == 6 * 3 + 6 * 6 + 8 * 4 + 8 * 8);
+
+  count = 0;
+  sum = 0;
+  vector<int> data{1, 2, 3, 4};
+  vector<I> rows;
+  for (const auto& it : data) rows.emplace_back(it);
+  fused->dataEvent(rows);
+  assert(count == 4);
+  assert(sum == 6 * 3 + 6 * 6 + 8 * 4 + 8 * 8);
+  fused->unNext(dumpfl.get());
+}
+
+void FusedBuilderTest() {
+  using std::tuple;
+  using std::vector;
+  using meta::slct;
+  using I = tuple<const int&>;
+  using O = tuple<const int&, const double&, const char&>;
+  auto isOutUnit = [](const auto& unit) {
+    return dynamic_cast<Source<O>*>(unit.get()) != nullptr;
+  };
+
+  // consecutive map and filter units are fused in a single unit.
+  auto src = std::make_shared<NoOp<I>>();
+  auto fl = ezl::flow(src)
+              .map([](int i) { return i / 2.; })
+              .filter([](int i, double) { return i % 2 == 0; })
+              .map([](int, double d) { return d > 1. ? 'b' : 's'; })
+              .build();
+  auto first = std::static_pointer_cast<NoOp<I>>(src->next().begin()->second);
+  assert(first->next().size() == 1);
+  assert(isOutUnit(first->next().begin()->second));
+
+  auto count = 0;
+  auto nBig = 0;
+  auto sink = [&count, &nBig](int, double, char c) {
+    ++count;
+    if (c == 'b') ++nBig;
+    return false;
+  };
+  auto dumpfl =
+      std::make_shared<Filter<O, slct<1, 2, 3>, decltype(sink), slct<1, 2, 3>>>(
+          sink);
+  fl->next(dumpfl, fl);
+  for (int i = 0; i < 10; ++i) src->dataEvent(I{i});
+  assert(count == 5);
+  assert(nBig == 3);
+  vector<int> data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  vector<I> rows;
+  for (const auto& it : data) rows.emplace_back(it);
+  src->dataEvent(rows);
+  assert(count == 10);
+  assert(nBig == 6);
+  fl->unNext(dumpfl.get());
+
+  // a branch from a unit keeps it apart from the next.
+  auto srcBranch = std::make_shared<NoOp<I>>();
+  ezl::flow(srcBranch)
+      .map([](int i) { return i / 2.; })
+      .map([](int, double d) { return d > 1. ? 'b' : 's'; }).oneUp()
+      .map([](int, double d) { return d > 2. ? 'b' : 's'; })
+      .build();
+  auto firstBranch =
+      std::static_pointer_cast<NoOp<I>>(srcBranch->next().begin()->second);
+  assert(firstBranch->next().size() == 1);
+  auto mid = firstBranch->next().begin()->second;
+  assert(!isOutUnit(mid));
+  auto midSrc = dynamic_cast<Source<tuple<const int&, const double&>>*>(
+      mid.get());
+  assert(midSrc != nullptr);
+  assert(midSrc->next().size() == 2);
+
+  // with same result from a flow with a rise, the rows of all the processes
+  auto res = ezl::rise(ezl::iota(10))
+                 .map([](int i) { return i / 2.; })
+                 .filter([](int i, double) { return i % 2 == 0; })
+                 .map([](int, double d) { return d > 1. ? 'b' : 's'; })
+                 .getAll();
+  assert(res.size() == 5);
+  assert(std::get<2>(res[4]) == 'b');
+  assert(std::get<2>(res[0]) == 's');
+}
+}
+} // namespace ezl namespace ezl::test
@@ -11,6 +11,7 @@
  * */
 
 #include <tuple>
+#include <vector>
 #include <type_traits>
 #include <assert.h>
 
@@ -31,9 +32,11 @@ auto f2() {  // used as UDF in a test
 void MapBasicCallTest();
 void MapCopyPerformanceTest();
 void MapReturnPerformanceTest();
+void MapBatchTest();
 
 void MapTest(int argc, char* argv[]) {
   MapBasicCallTest();
+  MapBatchTest();
   MapCopyPerformanceTest();
   MapReturnPerformanceTest();
 }
@@ -144,6 +147,44 @@ void MapBasicCallTest() {
   m2.dataEvent(std::tuple<>{});
 }
 
+// a batch gives same rows as the rows one by one, in a single batch.
+void MapBatchTest() {
+  using std::tuple;
+  using std::vector;
+  using meta::slct;
+  using ezl::detail::meta::MapTypes;
+
+  auto count = 0;
+  auto sum = 0;
+  auto sink = [&count, &sum](int i, int j) {
+    ++count;
+    sum += i * j;
+    return 0;
+  };
+  using otype = tuple<const int&, const int&>;
+  auto rec = std::make_shared<Map<MapTypes<otype, slct<1, 2>, decltype(sink), slct<3>>>>(sink);
+
+  auto twice = [](int i) { return 2 * i; };
+  auto m1 = std::make_shared<Map<MapTypes<tuple<int>, slct<1>, decltype(twice), slct<1, 2>>>>(twice);
+  m1->next(rec, m1);
+  m1->dataEvent(vector<tuple<int>>{tuple<int>{1}, tuple<int>{2}, tuple<int>{3}});
+  assert(count == 3);
+  assert(sum == 2 * (1 + 4 + 9));
+
+  count = 0;
+  sum = 0;
+  auto upto = [](int i) {
+    vector<int> v;
+    for (auto j = 0; j < i; ++j) v.push_back(j);
+    return v;
+  };
+  auto m2 = std::make_shared<Map<MapTypes<tuple<int>, slct<1>, decltype(upto), slct<1, 2>>>>(upto);
+  m2->next(rec, m2);
+  m2->dataEvent(vector<tuple<int>>{tuple<int>{0}, tuple<int>{2}, tuple<int>{3}});
+  assert(count == 5);
+  assert(sum == 2 * 1 + 3 * (1 + 2));
+}
+
 void MapCopyPerformanceTest() {
   using std::make_tuple;
   using meta::slct;
@@ -9,10 +9,15 @@
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
  * */
+#include <algorithm>
+#include <numeric>
 #include <tuple>
 #include <type_traits>
 #include <assert.h>
 
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/helper/RowRange.hpp>
 #include <ezl/units/Rise.hpp>
 #include <ezl/units/Filter.hpp>
 #include <ctorTeller.hpp>
@@ -22,9 +27,13 @@ namespace test {
 using namespace ezl::detail;
 
 void RiseBasicTest();
+void RiseKickTest();
+void RiseDynamicTest();
 
 void RiseTest(int argc, char* argv[]) {
   RiseBasicTest();
+  RiseKickTest();
+  RiseDynamicTest();
 }
 
 void RiseBasicTest() {
@@ -79,6 +88,107 @@ void RiseBasicTest() {
   r4->pull();
   assert(count == 0);
 
+  // a range of rows not owned by the UDF, passed as batches
+  count = 0;
+  vector<tuple<int, char>> rows(2500, make_tuple(1, 'a'));
+  auto first = 0;
+  auto f5 = [&rows, &first]() {
+    auto last = std::min(first + 1000, int(rows.size()));
+    auto res = makeRowRange(std::begin(rows) + first, std::begin(rows) + last);
+    first = last;
+    return res;
+  };
+  auto r5 = make_shared<Rise<decltype(f5)>>(ProcReq{1}, std::move(f5), nullptr);
+  static_assert(std::is_same<decltype(r5)::element_type::otype,
+                             tuple<const int&, const char&>>::value, "");
+  auto fret5 = [&count](int i, char c) { ++count; return i == 1 && c == 'a'; };
+  auto ret5 = make_shared<Filter<decltype(r5)::element_type::otype, slct<1, 2>,
+                                 decltype(fret5), slct<1>>>(fret5);
+  r5->par(pr);
+  r5->next(ret5, r5);
+  r5->pull();
+  assert(count == 2500);
+
+  // fromMem gives batches of rows of its share
+  count = 0;
+  auto f6 = ezl::fromMem(vector<int>(3000, 2), true);
+  auto r6 = make_shared<Rise<decltype(f6)>>(ProcReq{1}, std::move(f6), nullptr);
+  auto pr6 = Par{vector<int>{0, 1}, array<int, 3>{{1,2,3}}, 0};
+  r6->par(pr6);
+  r6->next(ret, r6);
+  r6->pull();
+  assert(count == 1500);
+
+  // a shared buffer and a view of memory, with no copy of the rows
+  count = 0;
+  auto shared = std::make_shared<const vector<int>>(300, 2);
+  auto f7 = ezl::fromMem(shared, true);
+  auto r7 = make_shared<Rise<decltype(f7)>>(ProcReq{1}, std::move(f7), nullptr);
+  r7->par(pr6);
+  r7->next(ret, r7);
+  r7->pull();
+  assert(count == 150);
+  count = 0;
+  auto f8 = ezl::fromMem(shared->data(), 100);
+  auto r8 = make_shared<Rise<decltype(f8)>>(ProcReq{1}, std::move(f8), nullptr);
+  r8->par(pr6);
+  r8->next(ret, r8);
+  r8->pull();
+  assert(count == 100);
+
+  // an rvalue buffer is moved in
+  vector<ctorTeller> tellers(3, ctorTeller{"", false, false});
+  auto f9 = ezl::fromMem(vector<ctorTeller>{});
+  ctorTeller::reset();
+  f9.buffer(std::move(tellers));
+  assert(ctorTeller::copyctor() == 0);
+}
+
+void RiseKickTest() {
+  // kick gives the calls in batches, a row for each call of the UDF
+  auto count = 0;
+  auto calls = [&count]() { return ++count; };
+  auto res = ezl::rise(ezl::kick(3000)).map(calls).get();
+  assert(int(res.size()) == count);
+  assert(ezl::rise(ezl::kick(3000)).map(calls).getAll().size() == 3000);
+
+  count = 0;
+  res = ezl::rise(ezl::kick(3000).dynamic(7)).map(calls).get();
+  assert(int(res.size()) == count);
+  assert(ezl::rise(ezl::kick(3000).dynamic(7)).map(calls).getAll().size() ==
+         3000);
+}
+
+void RiseDynamicTest() {
+  using std::tuple;
+  using std::vector;
+  // the chunks taken by the processes cover the rows once, in any order
+  vector<int> v(3000);
+  std::iota(std::begin(v), std::end(v), 0);
+  auto expected = vector<tuple<int>>(std::begin(v), std::end(v));
+  auto res = ezl::rise(ezl::fromMem(v).dynamic(7)).getAll();
+  std::sort(std::begin(res), std::end(res));
+  assert(res == expected);
+
+  res = ezl::rise(ezl::iota(0, 3000).dynamic(7)).getAll();
+  std::sort(std::begin(res), std::end(res));
+  assert(res == expected);
+
+  // chunks of a size for each process
+  res = ezl::rise(ezl::fromMem(v).dynamic()).getAll();
+  std::sort(std::begin(res), std::end(res));
+  assert(res == expected);
+
+  // fewer chunks than the processes
+  expected.resize(10);
+  res = ezl::rise(ezl::fromMem(vector<int>(std::begin(v), std::begin(v) + 10))
+                      .dynamic(5)).getAll();
+  std::sort(std::begin(res), std::end(res));
+  assert(res == expected);
+
+  res = ezl::rise(ezl::iota(0, 10).dynamic(5)).getAll();
+  std::sort(std::begin(res), std::end(res));
+  assert(res == expected);
 }
 }
 }
@@ -0,0 +1,138 @@
+/*!
+ * @file
+ * Basic tests for `RowStream.hpp` and `stream` of a dataflow.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <atomic>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/algorithms/reduces.hpp>
+#include <ezl/helper/RowStream.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void rowStreamIterTest();
+void rowStreamBatchTest();
+void rowStreamExceptionTest();
+void rowStreamRanksTest();
+
+void RowStreamTest(int argc, char* argv[]) {
+  rowStreamIterTest();
+  rowStreamBatchTest();
+  rowStreamExceptionTest();
+  rowStreamRanksTest();
+}
+
+// the rows of the flows are as many for each process, so that a process
+// streams its own share of the rows, from `first` of its rank.
+void rowStreamIterTest() {
+  const auto nProc = Karta::inst().nProc();
+  const auto first = 1000 * Karta::inst().rank();
+  auto st = ezl::rise(ezl::iota(1000 * nProc))
+                .map([](int i) { return i * 2; })
+                .stream({}, 64);
+  auto n = 0;
+  auto sum = 0LL;
+  for (const auto& it : st) {
+    assert(std::get<0>(it) == first + n);
+    sum += std::get<1>(it);
+    ++n;
+  }
+  assert(n == 1000);
+  assert(sum == (2LL * first + 999) * 1000);
+  // the stream is taken only once
+  assert(st.begin() == st.end());
+
+  auto empty = ezl::rise(ezl::iota(0)).stream();
+  assert(empty.begin() == empty.end());
+
+  // dropped before all the rows are taken, with the flow waiting.
+  {
+    auto part = ezl::rise(ezl::iota(100000 * nProc)).stream({}, 10, 1);
+    auto it = part.begin();
+    assert(std::get<0>(*it) == 100 * first);
+    ++it;
+    assert(std::get<0>(*it) == 100 * first + 1);
+  }
+}
+
+void rowStreamBatchTest() {
+  const auto nProc = Karta::inst().nProc();
+  const auto first = 20 * Karta::inst().rank();
+  auto st = ezl::rise(ezl::iota(1000 * nProc))
+                .filter([](int i) { return i % 2; })
+                .stream({}, 7);
+  std::vector<std::tuple<int>> batch;
+  auto n = 0;
+  auto isFirst = true;
+  while (st.next(batch)) {
+    if (isFirst) assert(batch.size() == 7);
+    isFirst = false;
+    assert(batch.size() <= 7);
+    n += batch.size();
+  }
+  assert(n == 500);
+  assert(!st.next(batch));
+
+  // rows and batches mixed
+  auto mixed = ezl::rise(ezl::iota(20 * nProc)).stream({}, 8);
+  auto it = mixed.begin();
+  ++it;
+  assert(std::get<0>(*it) == first + 1);
+  assert(mixed.next(batch));
+  assert(batch.size() == 7 && std::get<0>(batch[0]) == first + 1);
+  n = 8;
+  while (mixed.next(batch)) n += batch.size();
+  assert(n == 20);
+}
+
+void rowStreamExceptionTest() {
+  auto isCaught = false;
+  try {
+    // a row of each process throws
+    auto st = ezl::rise(ezl::iota(10 * Karta::inst().nProc()))
+                  .map([](int i) {
+                    if (i % 10 == 5) throw std::runtime_error("row five");
+                    return i;
+                  })
+                  .stream();
+    for (const auto& it : st) (void)it;
+  } catch (const std::runtime_error&) {
+    isCaught = true;
+  }
+  assert(isCaught);
+}
+
+void rowStreamRanksTest() {
+  // the flow runs on its thread as the rank that streams it.
+  std::atomic<int> nKeys{0};
+  runRanks(3, [&nKeys] {
+    auto st = ezl::rise(ezl::iota(3000))
+                  .map([](int i) { return i % 10; }).colsResult()
+                  .reduce<1>(ezl::count(), 0)
+                  .stream();
+    for (const auto& it : st) {
+      assert(std::get<1>(it) == 300);
+      ++nKeys;
+    }
+  });
+#ifdef NOMPI
+  assert(nKeys == 10);
+#endif
+}
+
+}
+}
@@ -0,0 +1,105 @@
+/*!
+ * @file
+ * Basic tests for `ThreadBridge.hpp` and units running on threads with
+ * `prll(threads(n))`.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/algorithms/reduces.hpp>
+#include <ezl/units/ThreadBridge.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void ThreadBridgeMapTest();
+void ThreadBridgeReduceTest();
+void ThreadBridgeExceptionTest();
+
+void ThreadBridgeTest(int argc, char* argv[]) {
+  ThreadBridgeMapTest();
+  ThreadBridgeReduceTest();
+  ThreadBridgeExceptionTest();
+}
+
+// the rows of all the processes are gathered with getAll, as the rows of the
+// rise are divided between the processes.
+void ThreadBridgeMapTest() {
+  auto res = ezl::rise(ezl::iota(10000))
+                 .map([](int i) { return i * 2; }).prll(threads(4))
+                 .filter([](int, int j) { return j % 3 == 0; })
+                 .getAll();
+  assert(res.size() == 3334);
+  std::sort(std::begin(res), std::end(res));
+  for (size_t i = 0; i < res.size(); ++i) {
+    assert(std::get<0>(res[i]) == int(i * 3));
+    assert(std::get<1>(res[i]) == int(i * 6));
+  }
+
+  // filter on threads followed by a map on the thread of the dataflow.
+  auto filtered = ezl::rise(ezl::iota(1000))
+                      .filter([](int i) { return i % 2 == 0; })
+                      .prll(threads(3))
+                      .map([](int i) { return -i; })
+                      .getAll();
+  assert(filtered.size() == 500);
+  auto sum = 0;
+  for (const auto& it : filtered) sum += std::get<1>(it);
+  assert(sum == -249500);
+}
+
+void ThreadBridgeReduceTest() {
+  // each key is reduced on one of the threads.
+  auto res = ezl::rise(ezl::iota(100000))
+                 .map([](int i) { return i % 7; }).colsResult()
+                 .reduce<1>(ezl::count(), 0).prll(threads(4))
+                 .getAll();
+  assert(res.size() == 7);
+  std::sort(std::begin(res), std::end(res));
+  for (auto i = 0; i < 7; ++i) {
+    assert(std::get<0>(res[i]) == i);
+    assert(std::get<1>(res[i]) == 100000 / 7 + (i < 100000 % 7 ? 1 : 0));
+  }
+
+  auto all = ezl::rise(ezl::iota(1000))
+                 .map([](int i) { return i % 10; })
+                 .reduceAll<2>([](int key, std::vector<int> vals) {
+                   return int(vals.size()) * key;
+                 }).prll(threads())
+                 .getAll();
+  assert(all.size() == 10);
+  auto total = 0;
+  for (const auto& it : all) total += std::get<1>(it);
+  assert(total == 100 * 45);
+}
+
+void ThreadBridgeExceptionTest() {
+  auto isThrown = false;
+  try {
+    // a row of each process throws
+    ezl::rise(ezl::iota(10000 * Karta::inst().nProc()))
+        .map([](int i) {
+          if (i % 10000 == 5000) throw std::runtime_error("map failed");
+          return i;
+        }).prll(threads(2))
+        .run();
+  } catch (const std::runtime_error&) {
+    isThrown = true;
+  }
+  assert(isThrown);
+}
+}
+} // namespace ezl namespace ezl::test
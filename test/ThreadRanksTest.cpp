@@ -0,0 +1,115 @@
+/*!
+ * @file
+ * Basic tests for `ThreadComm.hpp` and `QueueBridge.hpp`, dataflows on the
+ * ranks run by `runRanks`. With MPI the ranks are the processes.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/algorithms/reduces.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void ThreadRanksReduceTest();
+void ThreadRanksOrderedTest();
+void ThreadRanksExceptionTest();
+
+void ThreadRanksTest(int argc, char* argv[]) {
+  ThreadRanksReduceTest();
+  ThreadRanksOrderedTest();
+  ThreadRanksExceptionTest();
+}
+
+void ThreadRanksReduceTest() {
+  runRanks(4, [] {
+    const auto rank = Karta::inst().rank();
+    const auto nProc = Karta::inst().nProc();
+    assert(rank < nProc);
+    // rows of each rank are sent to the ranks of the reduce by key.
+    auto fl = ezl::rise(ezl::iota(10000))
+                  .map([](int i) { return i % 10; }).colsResult()
+                  .reduce<1>(ezl::count(), 0)
+                  .build();
+    auto res = ezl::flow(fl).get();
+    for (const auto& it : res) assert(std::get<1>(it) == 1000);
+    // the rows of each rank are counted across the ranks.
+    auto nRows = ezl::rise(ezl::fromMem({int(res.size())}))
+                     .reduce(ezl::sum(), 0).prll(1)
+                     .getAll();
+    assert(nRows.size() == 1 && std::get<0>(nRows[0]) == 10);
+
+    auto all = ezl::flow(fl).getAll();
+    assert(all.size() == 10);
+    std::sort(std::begin(all), std::end(all));
+    for (auto i = 0; i < 10; ++i) {
+      assert(std::get<0>(all[i]) == i);
+      assert(std::get<1>(all[i]) == 1000);
+    }
+
+    // the threads of a unit work for the rank of the flow.
+    auto ranks = ezl::rise(ezl::iota(100))
+                     .map([rank](int) { return Karta::inst().rank() == rank; })
+                       .colsResult().prll(threads(3))
+                     .getAll();
+    assert(ranks.size() == 100);
+    for (const auto& it : ranks) assert(std::get<0>(it));
+  });
+}
+
+void ThreadRanksOrderedTest() {
+  runRanks(3, [] {
+    // rows to all the ranks of the filter.
+    auto res = ezl::rise(ezl::iota(3000))
+                   .filter([](int i) { return i % 3 == 0; })
+                     .prll(1., llmode::dupe | llmode::task)
+                   .getAll();
+    assert(int(res.size()) == 1000 * Karta::inst().nProc());
+
+    // rows of a key sent together to the ranks of the reduce.
+    auto sum = ezl::rise(ezl::iota(3000))
+                   .map([](int i) { return i / 100; })
+                   .reduce<2>(ezl::sum(), 0).ordered()
+                   .map([](int, int s) { return s; }).colsResult()
+                   .reduce(ezl::sum(), 0).prll(1)
+                   .getAll();
+    assert(sum.size() == 1);
+    assert(std::get<0>(sum[0]) == 2999 * 1500);
+  });
+}
+
+void ThreadRanksExceptionTest() {
+#ifdef NOMPI
+  // the ranks waiting for the failed one are not left waiting.
+  auto isThrown = false;
+  try {
+    runRanks(3, [] {
+      ezl::rise(ezl::iota(10000))
+          .map([](int i) {
+            if (i == 5000) throw std::runtime_error("map failed");
+            return i % 5;
+          }).colsResult()
+          .reduce<1>(ezl::count(), 0)
+          .run();
+    });
+  } catch (const std::runtime_error& ex) {
+    isThrown = std::string{ex.what()} == "map failed";
+  }
+  assert(isThrown);
+#endif
+}
+}
+} // namespace ezl namespace ezl::test
@@ -0,0 +1,152 @@
+/*!
+ * @file
+ * Basic tests for `fromBinary.hpp` and `DumpBinary.hpp`
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl/algorithms/fromBinary.hpp>
+#include <ezl/helper/Par.hpp>
+#include <ezl/pipeline/Source.hpp>
+#include <ezl/units/DumpBinary.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void fromBinaryBasicTest();
+
+void fromBinaryTest(int argc, char* argv[]) {
+  fromBinaryBasicTest();
+}
+
+// rows read by process at position `pos` of `nProc` processes. The ids of
+// the processes are past the ranks of the running ones, so that the process
+// reads the share of the position by itself with MPI as well.
+template <class R>
+auto binaryRows(R r, int pos = 0, int nProc = 1) {
+  std::vector<int> procs;
+  for (auto i = 0; i < nProc; ++i) procs.push_back(Karta::inst().nProc() + i);
+  std::vector<std::decay_t<decltype(std::get<0>(r()))>> rows;
+  r(pos, procs);
+  while (true) {
+    auto res = r();
+    if (!std::get<1>(res)) break;
+    rows.push_back(std::get<0>(res));
+  }
+  return rows;
+}
+
+// dumps the rows with DumpBinary as done at the end of a unit.
+template <class Row>
+void dumpRows(const std::string& fname, const std::vector<Row>& rows,
+              size_t blockBytes) {
+  using ezl::Par;
+  auto d = DumpBinary<Row>{fname, blockBytes};
+  auto pr = Par{std::vector<int>{0}, std::array<int, 3>{{1,2,3}}, 0};
+  d.forwardPar(&pr);
+  for (const auto& it : rows) d.dataEvent(it);
+  d.signalEvent(1);
+}
+
+void fromBinaryBasicTest() {
+  using std::array;
+  using std::string;
+  using std::tuple;
+  using std::vector;
+  using Row = tuple<int, string, array<float, 2>, double>;
+
+  // a file for each rank as the ranks run the tests at the same time
+  const auto rank = std::to_string(Karta::inst().rank());
+  const string fname = "fromBinaryTest" + rank + ".ezb";
+  std::remove(fname.c_str());
+  vector<Row> all;
+  for (auto i = 0; i < 1000; ++i) {
+    all.emplace_back(i, string(i % 13, 'a' + i % 26),
+                     array<float, 2>{{i * 0.5F, -i * 1.F}}, i * 0.25);
+  }
+  // small blocks and appending to the file
+  auto half = all.begin() + 500;
+  dumpRows(fname, vector<Row>(all.begin(), half), 256);
+  dumpRows(fname, vector<Row>(half, all.end()), 256);
+  auto fromBin = [&fname]() {
+    return ezl::fromBinary<int, string, array<float, 2>, double>(fname);
+  };
+  assert(binaryRows(fromBin()) == all);
+
+  for (auto nProc : {2, 3, 7}) {
+    vector<Row> shares;
+    for (auto pos = 0; pos < nProc; ++pos) {
+      auto share = binaryRows(fromBin(), pos, nProc);
+      assert(!share.empty());
+      shares.insert(shares.end(), share.begin(), share.end());
+      assert(binaryRows(fromBin().split(false), pos, nProc) == all);
+    }
+    assert(shares == all);
+  }
+
+  // columns of the row referenced from the prior unit are written as values
+  using RefRow = tuple<const int&, const string&, const array<float, 2>&,
+                       const double&>;
+  const string refname = "fromBinaryRefTest" + rank + ".ezb";
+  std::remove(refname.c_str());
+  vector<RefRow> refs;
+  for (const auto& it : all) {
+    refs.emplace_back(std::get<0>(it), std::get<1>(it), std::get<2>(it),
+                      std::get<3>(it));
+  }
+  dumpRows(refname, refs, 1 << 20);
+  assert(binaryRows(ezl::fromBinary<int, string, array<float, 2>, double>(
+             vector<string>{refname, fname})).size() == 2 * all.size());
+
+  // different columns are neither read nor appended to
+  assert(binaryRows(ezl::fromBinary<int, string>(fname)).empty());
+  dumpRows(fname, vector<tuple<int>>{tuple<int>{1}}, 256);
+  assert(binaryRows(fromBin()) == all);
+  assert(binaryRows(ezl::fromBinary<int>("fromBinaryMissing*.ezb")).empty());
+
+  // a block with a number of rows that its columns do not fill exactly is
+  // not read, nor the blocks after it.
+  const string badname = "fromBinaryBadTest" + rank + ".ezb";
+  const vector<Row> ten(all.begin(), all.begin() + 10);
+  std::remove(badname.c_str());
+  dumpRows(badname, ten, 1 << 20);
+  string bytes;
+  {
+    std::ifstream in(badname, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+  }
+  const auto hsize = BinaryColumns<Row>::headerSize;
+  const auto block = bytes.substr(hsize);
+  for (auto nRows : {uint32_t(1000000), uint32_t(9)}) {
+    auto bad = block;
+    std::memcpy(&bad[4], &nRows, sizeof(nRows));
+    {
+      std::ofstream out(badname, std::ios::binary);
+      out << bytes.substr(0, hsize) << block << bad << block;
+    }
+    assert(binaryRows(ezl::fromBinary<int, string, array<float, 2>, double>(
+               badname)) == ten);
+  }
+  std::remove(badname.c_str());
+
+  std::remove(fname.c_str());
+  std::remove(refname.c_str());
+}
+}
+}
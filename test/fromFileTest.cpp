@@ -10,13 +10,23 @@
  * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
  * */
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <tuple>
 #include <vector>
 #include <type_traits>
 #include <assert.h>
+#include <stdlib.h>
+
+#include <boost/algorithm/string.hpp>
+#ifdef EZL_ZLIB
+#include <zlib.h>
+#endif
 
 #include <ezl/algorithms/fromFile.hpp>
+#include <ezl/helper/DelimSet.hpp>
 #include <ezl/helper/ProcReq.hpp>
 #include <ezl/units/Filter.hpp>
 #include <ezl/units/Rise.hpp>
@@ -34,14 +44,34 @@ void fromFileTest(int argc, char* argv[]) {
 void fromFileStrictSchemaTest();
 void fromFileFileNameTest();
 void fromFileRowMaxTest();
+void fromFileMemoryMapTest();
+void fromFileDelimTest();
+void fromFileSlctTest();
+void fromFileThreadsTest();
+void fromFilePrefetchTest();
+void fromFileGzipTest();
+void fromFileCacheTest();
+void fromFileDivideTest();
+void fromFileDynamicTest();
+void fromFileNoEndTest();
+std::string tmpPath(const std::string& name);
 
 void fromFileBasicTest() {
   fromFileStrictSchemaTest();
   fromFileFileNameTest();
   fromFileRowMaxTest();
-  //fromFileDelimTest();
-  //fromFileSlctTest();
+  fromFileMemoryMapTest();
+  fromFileDelimTest();
+  fromFileSlctTest();
+  fromFileThreadsTest();
+  fromFilePrefetchTest();
+  fromFileGzipTest();
+  fromFileCacheTest();
+  fromFileDivideTest();
+  fromFileDynamicTest();
+  fromFileNoEndTest();
   //fromFilePreCheckTest();
+  std::remove(tmpPath("").c_str());  // the directory, empty by now
 }
 
 void fromFileFileNameTest() {
@@ -147,5 +177,612 @@ void fromFileStrictSchemaTest() {
   t4->pull();
   assert(count == 14);
 }
+
+// path of a file written by a test, in a directory of its own in the temp
+// directory so that the ranks running the tests at the same time do not
+// write the same file and a killed run leaves nothing in the working
+// directory.
+std::string tmpPath(const std::string& name) {
+  static const std::string dir = [] {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string pat = std::string{tmp ? tmp : "/tmp"} + "/ezlTestXXXXXX";
+    std::vector<char> buf(pat.begin(), pat.end());
+    buf.push_back('\0');
+    return std::string{::mkdtemp(buf.data()) ? buf.data() : "."};
+  }();
+  return dir + "/" + name;
+}
+
+// rows read by process at position `pos` of `nProc` processes. The ids of
+// the processes are past the ranks of the running ones, so that the process
+// reads the share of the position by itself with MPI as well.
+template <class R>
+auto readRows(R&& r, int pos = 0, int nProc = 1) {
+  using meta::slct;
+  using otype = typename std::decay_t<R>::otype;
+  auto t = std::make_shared<Rise<R>>(ProcReq{}, std::forward<R>(r), nullptr);
+  std::vector<otype> rows;
+  auto f = [&rows](const otype& row) { rows.push_back(row); return true; };
+  using all = typename meta::fillSlct<0, std::tuple_size<otype>::value>::type;
+  auto ret = std::make_shared<
+      Filter<typename Rise<R>::otype, all, decltype(f), slct<>>>(f);
+  t->next(ret, t);
+  std::vector<int> procs;
+  for (auto i = 0; i < nProc; ++i) procs.push_back(Karta::inst().nProc() + i);
+  t->par(Par{procs, std::array<int, 3>{{1,2,3}}, procs[pos]});
+  t->pull();
+  return rows;
+}
+
+void fromFileMemoryMapTest() {
+  using std::string;
+  using std::array;
+
+  const string files = "data/fromFileTests/test?.txt";
+  using Rows = std::vector<std::tuple<string, int>>;
+  assert(readRows(ezl::fromFile<string, int, float>(files)
+                  .memoryMap()).size() == 6);
+  assert(readRows(ezl::fromFile<string, int, float>(files).memoryMap()
+                  .strictSchema(false)).size() == 14);
+  assert(readRows(ezl::fromFile<string, int>(files).memoryMap()).size() == 6);
+  assert(readRows(ezl::fromFile<string, int, float, string>(files).memoryMap()
+                  .addFileName().limitRows(2)).size() == 2);
+  assert(readRows(ezl::fromFile<string>(files).memoryMap().rowSeparator('s')
+                  .colSeparator("")) == readRows(ezl::fromFile<string>(files)
+                  .rowSeparator('s').colSeparator("")));
+
+  // shares of processes add to the same rows as a single process
+  const string lammps = "data/lammps/dump.txt";
+  auto lammpsRows = [&lammps](bool isMmap, int pos, int nProc) {
+    return readRows(ezl::fromFile<int, array<float, 3>, int>(lammps)
+                    .cols({1, 3, 4, 5, 6}).lammps().memoryMap(isMmap),
+                    pos, nProc);
+  };
+  auto total = lammpsRows(false, 0, 1);
+  assert(total.size() == 20);
+  for (auto nProc : {2, 3, 5}) {
+    decltype(total) shares, sharesMmap;
+    Rows rows, rowsMmap;
+    for (auto pos = 0; pos < nProc; ++pos) {
+      auto share = lammpsRows(false, pos, nProc);
+      shares.insert(shares.end(), share.begin(), share.end());
+      share = lammpsRows(true, pos, nProc);
+      sharesMmap.insert(sharesMmap.end(), share.begin(), share.end());
+      auto part = readRows(ezl::fromFile<string, int>(files), pos, nProc);
+      rows.insert(rows.end(), part.begin(), part.end());
+      part = readRows(ezl::fromFile<string, int>(files).memoryMap(),
+                      pos, nProc);
+      rowsMmap.insert(rowsMmap.end(), part.begin(), part.end());
+    }
+    assert(shares == total);
+    assert(sharesMmap == total);
+    assert(rows.size() == 6);
+    assert(rowsMmap == rows);
+  }
+}
+
+void fromFileDelimTest() {
+  using std::string;
+  using std::vector;
+
+  auto split = [](const DelimSet& ds, const string& s) {
+    vector<string> res;
+    ds.tokens(s.data(), s.data() + s.size(), [&res](const char* b, const char* e) {
+      res.emplace_back(b, e);
+      return true;
+    });
+    return res;
+  };
+  auto boostSplit = [](const string& delims, const string& s) {
+    vector<string> res;
+    boost::split(res, s, boost::is_any_of(delims), boost::token_compress_on);
+    if (!res.empty() && res.back().empty()) res.pop_back();
+    if (!res.empty() && res.front().empty()) res.erase(res.begin());
+    return res;
+  };
+  // lines longer than a simd block with tokens crossing the blocks
+  vector<string> lines {"", " ", "a", " a ", "ab  cd\tef", "\t\t x,y,,z \t",
+    "1 2.5 3.25 4.125 5.0625 6.03125 7.015625 8.0078125 9.00390625 10.001953125",
+    "  lorem,ipsum\tdolor sit,,amet\t\tconsectetur adipiscing,elit sed do   ",
+    string(70, ' ') + "x" + string(33, ',') + "yz" + string(31, 'w')};
+  for (auto delims : {" ", " \t", ",", "\t, ", " \t,;:|!?@#"}) {
+    DelimSet ds{delims};
+    for (const auto& it : lines) assert(split(ds, it) == boostSplit(delims, it));
+  }
+  DelimSet ds{" \t"};
+  const auto& s = lines[6];
+  auto first = s.data();
+  auto last = s.data() + s.size();
+  assert(ds.find(first, last) == first + 1);
+  assert(ds.skip(first, last) == first);
+  assert(ds.skip(first + 1, last) == first + 2);
+  assert(ds.find(first + 67, last) == last);
+  string spaces(40, ' ');
+  assert(ds.skip(spaces.data(), spaces.data() + 40) == spaces.data() + 40);
+  // stops when asked to
+  auto count = 0;
+  ds.tokens(first, last, [&count](const char*, const char*) { return ++count < 3; });
+  assert(count == 3);
+}
+void fromFileSlctTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+  using std::make_tuple;
+
+  const string fname = tmpPath("fromFileSlctTest.txt");
+  std::ofstream(fname) << "a b c d e f g h\n"
+                          "1 2 3 4 5 6 7 8\n"
+                          "11 12 13 14 15 16 17 18\n"
+                          "21 22 23\n"
+                          "31 32 33 34 35 36 37 38 39\n";
+  for (auto isMmap : {false, true}) {
+    auto twoCols = [&fname, isMmap]() {
+      return ezl::fromFile<int, int>(fname).memoryMap(isMmap);
+    };
+    using Two = vector<tuple<int, int>>;
+    assert(readRows(twoCols().cols({2, 7})) ==
+           (Two{make_tuple(2, 7), make_tuple(12, 17), make_tuple(32, 37)}));
+    assert(readRows(twoCols().cols({7, 2})) ==
+           (Two{make_tuple(7, 2), make_tuple(17, 12), make_tuple(37, 32)}));
+    assert(readRows(twoCols().cols({string{"g"}, string{"b"}})) ==
+           (Two{make_tuple(7, 2), make_tuple(17, 12), make_tuple(37, 32)}));
+    assert(readRows(twoCols().dropCols({1, 3}).cols({2, 4})) ==
+           (Two{make_tuple(4, 6), make_tuple(14, 16), make_tuple(34, 36)}));
+    // mask selection requires exact number of columns
+    assert(readRows(twoCols().cols({0, 1, 0, 0, 0, 0, 1, 0})) ==
+           (Two{make_tuple(2, 7), make_tuple(12, 17)}));
+    assert(readRows(twoCols().cols({2, 7}).strictSchema(false)) ==
+           (Two{make_tuple(2, 7), make_tuple(12, 17), make_tuple(22, 0),
+                make_tuple(32, 37)}));
+    assert(readRows(twoCols().cols({2, 7}).parse(
+               [](vector<string>&) { return std::make_pair(true, rs::nobr); }))
+           == (Two{make_tuple(2, 7), make_tuple(12, 17), make_tuple(32, 37)}));
+
+    // without selection the row after dropping should match exactly
+    using Six = vector<tuple<int, int, int, int, int, int>>;
+    auto six = readRows(ezl::fromFile<int, int, int, int, int, int>(fname)
+                        .dropCols({3, 1}).memoryMap(isMmap));
+    assert(six == (Six{make_tuple(2, 4, 5, 6, 7, 8),
+                       make_tuple(12, 14, 15, 16, 17, 18)}));
+    assert(six == readRows(ezl::fromFile<int, int, int, int, int, int>(fname)
+                           .dropCols({string{"a"}, string{"c"}})
+                           .memoryMap(isMmap)));
+
+    // file name is the last column of the row
+    auto named = readRows(ezl::fromFile<int, int, string>(fname)
+                          .cols({2, 7, 9}).addFileName().memoryMap(isMmap));
+    assert((named == vector<tuple<int, int, string>>{
+                make_tuple(2, 7, fname), make_tuple(12, 17, fname),
+                make_tuple(32, 37, string{"39"})}));
+  }
+  std::remove(fname.c_str());
+}
+void fromFileThreadsTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+
+  const string fname = tmpPath("fromFileThreadsTest.txt");
+  {
+    std::ofstream f(fname);
+    for (auto i = 0; i < 5000; ++i) {
+      f << "r" << i << " " << i << "  " << i * 0.5 << "\n";
+      if (i % 7 == 0) f << "bad row\n";
+    }
+    f << "r5000 5000 2500";  // without row separator at the end
+  }
+  using Row = tuple<string, int, float>;
+  auto serial = [&fname]() {
+    return ezl::fromFile<string, int, float>(fname).memoryMap();
+  };
+  auto all = readRows(serial());
+  assert(all.size() == 5000);
+  for (auto nThreads : {2, 3, 8}) {
+    auto threaded = [&fname, nThreads](bool keepOrder) {
+      return ezl::fromFile<string, int, float>(fname).threads(nThreads,
+                                                              keepOrder);
+    };
+    assert(readRows(threaded(true)) == all);
+    auto unordered = readRows(threaded(false));
+    std::sort(unordered.begin(), unordered.end(),
+              [](const Row& a, const Row& b) { return std::get<1>(a) <
+                                                      std::get<1>(b); });
+    assert(unordered == all);
+    for (auto nProc : {2, 3, 5}) {
+      vector<Row> shares;
+      for (auto pos = 0; pos < nProc; ++pos) {
+        auto share = readRows(threaded(true), pos, nProc);
+        assert(share == readRows(serial(), pos, nProc));
+        shares.insert(shares.end(), share.begin(), share.end());
+      }
+      assert(shares == all);
+    }
+    auto limited = readRows(threaded(true).limitRows(10));
+    assert(limited == vector<Row>(all.begin(), all.begin() + 10));
+    assert(readRows(ezl::fromFile<int, float, string>(fname).cols({2, 3, 4})
+                    .addFileName().strictSchema(false).threads(nThreads)) ==
+           readRows(ezl::fromFile<int, float, string>(fname).cols({2, 3, 4})
+                    .addFileName().strictSchema(false).memoryMap()));
+    assert(readRows(ezl::fromFile<string>(fname).rowSeparator('s')
+                    .threads(nThreads)) ==
+           readRows(ezl::fromFile<string>(fname).rowSeparator('s')
+                    .memoryMap()));
+    const string files = "data/fromFileTests/test?.txt";
+    for (auto nProc : {1, 2, 3}) {
+      for (auto pos = 0; pos < nProc; ++pos) {
+        assert(readRows(ezl::fromFile<string, int>(files).threads(nThreads),
+                        pos, nProc) ==
+               readRows(ezl::fromFile<string, int>(files).memoryMap(),
+                        pos, nProc));
+        assert(readRows(ezl::fromFile<string, int>(files).tillEOF()
+                        .threads(nThreads), pos, nProc) ==
+               readRows(ezl::fromFile<string, int>(files).tillEOF()
+                        .memoryMap(), pos, nProc));
+      }
+    }
+  }
+  std::remove(fname.c_str());
+}
+void fromFilePrefetchTest() {
+  using std::string;
+  using std::array;
+
+  // small blocks to have rows split between blocks
+  const string files = "data/fromFileTests/test?.txt";
+  const string lammps = "data/lammps/dump.txt";
+  for (auto bytes : {1, 7, 64, 1 << 20}) {
+    for (auto depth : {1, 2}) {
+      for (auto nProc : {1, 2, 3}) {
+        for (auto pos = 0; pos < nProc; ++pos) {
+          assert(readRows(ezl::fromFile<string, int>(files)
+                          .prefetch(bytes, depth), pos, nProc) ==
+                 readRows(ezl::fromFile<string, int>(files).memoryMap(),
+                          pos, nProc));
+          assert(readRows(ezl::fromFile<string, int, float>(files)
+                          .strictSchema(false).tillEOF()
+                          .prefetch(bytes, depth), pos, nProc) ==
+                 readRows(ezl::fromFile<string, int, float>(files)
+                          .strictSchema(false).tillEOF().memoryMap(),
+                          pos, nProc));
+          assert(readRows(ezl::fromFile<string>(files).rowSeparator('s')
+                          .colSeparator("").prefetch(bytes, depth),
+                          pos, nProc) ==
+                 readRows(ezl::fromFile<string>(files).rowSeparator('s')
+                          .colSeparator("").memoryMap(), pos, nProc));
+          assert(readRows(ezl::fromFile<int, array<float, 3>, int>(lammps)
+                          .cols({1, 3, 4, 5, 6}).lammps()
+                          .prefetch(bytes, depth), pos, nProc) ==
+                 readRows(ezl::fromFile<int, array<float, 3>, int>(lammps)
+                          .cols({1, 3, 4, 5, 6}).lammps().memoryMap(),
+                          pos, nProc));
+        }
+      }
+    }
+  }
+  assert(readRows(ezl::fromFile<string, int, float>(files).prefetch(5)
+                  .limitRows(2)).size() == 2);
+  const std::vector<string> missing{"fromFileMissing.txt",
+                                    "data/fromFileTests/test1.txt"};
+  assert(readRows(ezl::fromFile<string, int>(missing).prefetch()) ==
+         readRows(ezl::fromFile<string, int>(missing).memoryMap()));
+}
+
+#ifdef EZL_ZLIB
+// blocked gzip as written by bgzip, with the `.gzi` index if `isIndex`.
+void writeBgzf(const std::string& fname, const std::string& data,
+               size_t blockSize, bool isIndex = false) {
+  std::ofstream f(fname, std::ios::binary);
+  std::vector<unsigned long long> offsets;
+  auto block = [&f, &offsets](const char* p, size_t n) {
+    if (f.tellp() > 0) offsets.push_back(f.tellp());
+    z_stream zs{};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                 Z_DEFAULT_STRATEGY);
+    std::vector<unsigned char> out(deflateBound(&zs, n));
+    zs.next_in = (Bytef*)p;
+    zs.avail_in = n;
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    auto clen = out.size() - zs.avail_out;
+    deflateEnd(&zs);
+    auto bsize = 18 + clen + 8 - 1;
+    unsigned char h[18] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0,
+                           'B', 'C', 2, 0, (unsigned char)(bsize & 0xff),
+                           (unsigned char)(bsize >> 8)};
+    f.write((const char*)h, 18);
+    f.write((const char*)out.data(), clen);
+    unsigned long t[2] = {crc32(0, (const Bytef*)p, n), n};
+    for (auto it : t) {
+      for (auto i = 0; i < 4; ++i) f.put(char((it >> (8 * i)) & 0xff));
+    }
+  };
+  for (size_t i = 0; i < data.size(); i += blockSize) {
+    block(data.data() + i, std::min(blockSize, data.size() - i));
+  }
+  block(nullptr, 0);  // end of file marker
+  if (!isIndex) return;
+  std::ofstream idx(fname + ".gzi", std::ios::binary);
+  auto put = [&idx](unsigned long long v) {
+    for (auto i = 0; i < 8; ++i) idx.put(char((v >> (8 * i)) & 0xff));
+  };
+  put(offsets.size());
+  for (auto it : offsets) {
+    put(it);
+    put(0);  // uncompressed offset, not used
+  }
+}
+
+void fromFileGzipTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+
+  string data;
+  for (auto i = 0; i < 3000; ++i) {
+    data += "r" + std::to_string(i) + " " + std::to_string(i) + "  " +
+            std::to_string(i * 0.5) + "\n";
+    if (i % 7 == 0) data += "bad row\n";
+  }
+  const string plain = tmpPath("fromFileGzipTest.txt");
+  const string gz = plain + ".gz";
+  const string bgz = plain + ".bgz";
+  std::ofstream(plain) << data;
+  // two members, as by concatenating gzip files
+  auto half = data.size() / 2;
+  for (auto mode : {"wb", "ab"}) {
+    auto f = gzopen(gz.c_str(), mode);
+    auto first = (mode[0] == 'w') ? 0 : half;
+    auto n = (mode[0] == 'w') ? half : data.size() - half;
+    gzwrite(f, data.data() + first, n);
+    gzclose(f);
+  }
+  writeBgzf(bgz, data, 500);
+
+  using Row = tuple<string, int, float>;
+  auto all = readRows(ezl::fromFile<string, int, float>(plain));
+  assert(all.size() == 3000);
+  for (const auto& it : {gz, bgz}) {
+    assert(readRows(ezl::fromFile<string, int, float>(it)) == all);
+    assert(readRows(ezl::fromFile<string, int, float>(it).memoryMap()) == all);
+    assert(readRows(ezl::fromFile<string, int, float>(it).prefetch()) == all);
+    assert(readRows(ezl::fromFile<string, int, float>(it).threads(2)) == all);
+    assert(readRows(ezl::fromFile<string>(it).rowSeparator('s')) ==
+           readRows(ezl::fromFile<string>(plain).rowSeparator('s')));
+  }
+  // the blocked file is shared by blocks, the other is read whole
+  const vector<string> mixed{plain, bgz, plain};
+  const vector<string> mixedGz{plain, gz, plain};
+  for (auto nProc : {2, 3, 5, 16}) {
+    vector<Row> shares, mixedShares, mixedGzShares;
+    auto nonEmpty = 0;
+    for (auto pos = 0; pos < nProc; ++pos) {
+      auto share = readRows(ezl::fromFile<string, int, float>(bgz), pos, nProc);
+      if (!share.empty()) nonEmpty++;
+      shares.insert(shares.end(), share.begin(), share.end());
+      share = readRows(ezl::fromFile<string, int, float>(mixed), pos, nProc);
+      mixedShares.insert(mixedShares.end(), share.begin(), share.end());
+      share = readRows(ezl::fromFile<string, int, float>(mixedGz), pos, nProc);
+      mixedGzShares.insert(mixedGzShares.end(), share.begin(), share.end());
+    }
+    assert(shares == all);
+    assert(nonEmpty == nProc);
+    assert(mixedShares.size() == 3 * all.size());
+    assert(mixedGzShares.size() == 3 * all.size());
+    for (size_t i = 0; i < mixedShares.size(); ++i) {
+      assert(mixedShares[i] == all[i % all.size()]);
+    }
+  }
+  // the blocks are seeked with the index
+  writeBgzf(bgz, data, 500, true);
+  for (auto nProc : {2, 3, 5, 16}) {
+    vector<Row> shares;
+    for (auto pos = 0; pos < nProc; ++pos) {
+      auto share = readRows(ezl::fromFile<string, int, float>(bgz), pos, nProc);
+      assert(!share.empty());
+      shares.insert(shares.end(), share.begin(), share.end());
+    }
+    assert(shares == all);
+  }
+  // reading a gzip file whole is decided again in the next run
+  const string swap = plain + ".swap.gz";
+  std::rename(gz.c_str(), swap.c_str());
+  auto reader = ezl::fromFile<string, int, float>(swap);
+  assert(readRows(reader, 0, 2).size() == all.size());
+  writeBgzf(swap, data, 500);
+  auto first = readRows(reader, 0, 2);
+  auto second = readRows(reader, 1, 2);
+  assert(!first.empty() && !second.empty());
+  assert(first.size() + second.size() == all.size());
+  std::remove(plain.c_str());
+  std::remove(swap.c_str());
+  std::remove(bgz.c_str());
+  std::remove((bgz + ".gzi").c_str());
+}
+#else
+void fromFileGzipTest() {}
+#endif
+
+void fromFileCacheTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+
+  const string fname = tmpPath("fromFileCacheTest.txt");
+  const string dir = tmpPath("fromFileCacheTest.d");
+  auto write = [&fname](int n) {
+    std::ofstream f(fname);
+    for (auto i = 0; i < n; ++i) f << "r" << i << " " << i << " " << i * 0.5 << "\n";
+  };
+  write(3000);
+  // counts the rows parsed, a cache hit parses none
+  auto nParsed = 0;
+  auto reader = [&fname, &dir, &nParsed]() {
+    return ezl::fromFile<string, int, float>(fname).cache(dir)
+        .parse([&nParsed](vector<string>&) {
+          ++nParsed;
+          return std::make_pair(true, rs::br);
+        });
+  };
+  auto all = readRows(ezl::fromFile<string, int, float>(fname));
+  assert(all.size() == 3000);
+  assert(readRows(reader()) == all);
+  assert(nParsed == 3000);
+  nParsed = 0;
+  assert(readRows(reader()) == all);
+  assert(nParsed == 0);
+  // a cache for each position of process
+  vector<tuple<string, int, float>> shares;
+  for (auto pos = 0; pos < 3; ++pos) {
+    auto share = readRows(reader(), pos, 3);
+    shares.insert(shares.end(), share.begin(), share.end());
+  }
+  assert(shares == all);
+  nParsed = 0;
+  assert(readRows(reader(), 1, 3) == readRows(
+      ezl::fromFile<string, int, float>(fname), 1, 3));
+  assert(nParsed == 0);
+  // different options, read mode, parse check or changed file are parsed
+  // again
+  assert(readRows(reader().limitRows(5)).size() == 5);
+  assert(nParsed == 5);
+  nParsed = 0;
+  assert(readRows(reader().memoryMap()) == all);
+  assert(nParsed == 3000);
+  nParsed = 0;
+  assert(readRows(reader().prefetch(64)) == all);
+  assert(nParsed == 3000);
+  auto nOther = 0;
+  auto other = readRows(ezl::fromFile<string, int, float>(fname).cache(dir)
+      .parse([&nOther](vector<string>& v) {
+        ++nOther;
+        return std::make_pair(v[1] == "7", rs::br);
+      }));
+  assert(nOther == 3000);
+  assert(other.size() == 1);
+  write(3500);
+  nParsed = 0;
+  assert(readRows(reader()).size() == 3500);
+  assert(nParsed == 3500);
+
+  for (const auto& it : detail::vglob(dir + "/*")) std::remove(it.c_str());
+  std::remove(dir.c_str());
+  std::remove(fname.c_str());
+}
+
+void fromFileDivideTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+
+  assert((sizeShare({40, 10, 10, 10, 10}, 0, 2) == vector<size_t>{0}));
+  assert((sizeShare({40, 10, 10, 10, 10}, 1, 2) ==
+          vector<size_t>{1, 2, 3, 4}));
+  assert((sizeShare({0, 0, 0, 0}, 1, 2) == vector<size_t>{1, 3}));
+  assert(sizeShare({5}, 1, 2).empty());
+
+  // whole files are given balancing the bytes rather than the count
+  vector<string> fnames;
+  vector<tuple<string, int>> all;
+  for (auto i : {0, 1, 2, 3}) {
+    fnames.push_back(tmpPath("fromFileDivideTest" + std::to_string(i) +
+                             ".txt"));
+    std::ofstream f(fnames.back());
+    for (auto j = 0; j < (i == 0 ? 300 : 100); ++j) {
+      f << "r" << i << " " << j << "\n";
+      all.emplace_back("r" + std::to_string(i), j);
+    }
+  }
+  auto first = readRows(ezl::fromFile<string, int>(fnames).tillEOF(), 0, 2);
+  auto second = readRows(ezl::fromFile<string, int>(fnames).tillEOF(), 1, 2);
+  assert((first == vector<tuple<string, int>>(all.begin(), all.begin() + 300)));
+  assert((second == vector<tuple<string, int>>(all.begin() + 300, all.end())));
+  assert(readRows(ezl::fromFile<string, int>(fnames).tillEOF()
+                  .memoryMap(), 1, 2) == second);
+  assert(readRows(ezl::fromFile<string, int>(fnames).tillEOF(), 4, 5).empty());
+
+  for (const auto& it : fnames) std::remove(it.c_str());
+}
+
+void fromFileDynamicTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+  using Row = tuple<string, int>;
+
+  const string files = "data/fromFileTests/test?.txt";
+  auto all = readRows(ezl::fromFile<string, int>(files));
+  auto sorted = [](vector<Row> rows) {
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+  // chunks of a few bytes to have rows split between the chunks
+  for (auto bytes : {1, 7, 64, 0}) {
+    for (auto nProc : {1, 2, 3}) {
+      vector<Row> shares, mapped, whole;
+      for (auto pos = 0; pos < nProc; ++pos) {
+        auto share = readRows(ezl::fromFile<string, int>(files)
+                              .dynamic(bytes), pos, nProc);
+        shares.insert(shares.end(), share.begin(), share.end());
+        share = readRows(ezl::fromFile<string, int>(files).memoryMap()
+                         .dynamic(bytes), pos, nProc);
+        mapped.insert(mapped.end(), share.begin(), share.end());
+        share = readRows(ezl::fromFile<string, int>(files).tillEOF()
+                         .dynamic(bytes), pos, nProc);
+        whole.insert(whole.end(), share.begin(), share.end());
+      }
+      assert(sorted(shares) == sorted(all));
+      assert(sorted(mapped) == sorted(all));
+      assert(sorted(whole) == sorted(all));
+    }
+  }
+  assert(readRows(ezl::fromFile<string, int>(files).dynamic(7)
+                  .limitRows(2)).size() == 2);
+}
+
+void fromFileNoEndTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+  using std::make_tuple;
+
+  // the last row without a row separator is not read in any of the modes
+  const string fname = tmpPath("fromFileNoEndTest.txt");
+  std::ofstream(fname) << "a 1\nb 2\nc 3";
+  using Rows = vector<tuple<string, int>>;
+  const Rows two{make_tuple("a", 1), make_tuple("b", 2)};
+  auto reader = [&fname]() { return ezl::fromFile<string, int>(fname); };
+  assert(readRows(reader()) == two);
+  assert(readRows(reader().tillEOF()) == two);
+  assert(readRows(reader().dynamic(2)) == two);
+  assert(readRows(reader().memoryMap()) == two);
+  assert(readRows(reader().threads(2)) == two);
+  assert(readRows(reader().prefetch(4)) == two);
+  for (auto nProc : {2, 3}) {
+    for (auto pos = 0; pos < nProc; ++pos) {
+      assert(readRows(reader().memoryMap(), pos, nProc) ==
+             readRows(reader(), pos, nProc));
+      assert(readRows(reader().threads(2), pos, nProc) ==
+             readRows(reader(), pos, nProc));
+      assert(readRows(reader().prefetch(4), pos, nProc) ==
+             readRows(reader(), pos, nProc));
+    }
+  }
+  const vector<string> words{"a", "1", "b", "2", "c"};
+  auto wordRows = [](vector<tuple<string>> rows) {
+    vector<string> res;
+    for (const auto& it : rows) res.push_back(std::get<0>(it));
+    return res;
+  };
+  auto wordReader = [&fname]() {
+    return ezl::fromFile<string>(fname).rowSeparator('s').colSeparator("");
+  };
+  assert(wordRows(readRows(wordReader())) == words);
+  assert(wordRows(readRows(wordReader().memoryMap())) == words);
+  assert(wordRows(readRows(wordReader().threads(2))) == words);
+  assert(wordRows(readRows(wordReader().prefetch(4))) == words);
+  std::remove(fname.c_str());
+}
 }
 }
@@ -0,0 +1,145 @@
+/*!
+ * @file
+ * Basic tests for `fromLammps.hpp`
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+#include <stdlib.h>
+
+#include <ezl/algorithms/fromFile.hpp>
+#include <ezl/algorithms/fromLammps.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void fromLammpsBasicTest();
+
+void fromLammpsTest(int argc, char* argv[]) {
+  fromLammpsBasicTest();
+}
+
+// rows read by process at position `pos` of `nProc` processes. The ids of
+// the processes are past the ranks of the running ones, so that the process
+// reads the share of the position by itself with MPI as well.
+template <class R>
+auto lammpsRows(R&& r, int pos = 0, int nProc = 1) {
+  std::vector<int> procs;
+  for (auto i = 0; i < nProc; ++i) procs.push_back(Karta::inst().nProc() + i);
+  std::vector<std::decay_t<decltype(std::get<0>(r()))>> rows;
+  r(pos, procs);
+  while (true) {
+    auto res = r();
+    if (!std::get<1>(res)) break;
+    rows.push_back(std::get<0>(res));
+  }
+  return rows;
+}
+
+void fromLammpsBasicTest() {
+  using std::array;
+  const std::string fpat = "data/lammps/dump*.txt";
+  const std::vector<std::string> fnames{"data/lammps/dump.txt",
+                                        "data/lammps/dump6000.txt"};
+  auto atoms = fromLammps<int, array<float, 3>, int>(fpat).cols({1, 3, 4, 5});
+  // fromFile gives the rows in batches
+  auto parsed = fromFile<int, array<float, 3>, int>(fpat)
+                    .cols({1, 3, 4, 5, 6}).lammps();
+  parsed(0, std::vector<int>{0});
+  decltype(lammpsRows(atoms)) expected;
+  for (auto rows = parsed(); !rows.empty(); rows = parsed()) {
+    expected.insert(std::end(expected), std::begin(rows), std::end(rows));
+  }
+  assert(expected.size() == 30);
+  assert(lammpsRows(atoms) == expected);
+  // nothing is written next to the dumps by default
+  for (const auto& it : fnames) {
+    assert(!std::ifstream(LammpsIndex::sidecar(it)).good());
+  }
+
+  // the sidecar is kept in a directory of its own for each process, as the
+  // ranks run the tests at the same time, and is read the second time.
+  std::string dir = "/tmp/ezlLammpsXXXXXX";
+  if (const char* tmp = std::getenv("TMPDIR")) {
+    dir = std::string{tmp} + "/ezlLammpsXXXXXX";
+  }
+  auto isDir = ::mkdtemp(&dir[0]) != nullptr;
+  assert(isDir);
+  auto indexed = fromLammps<int, array<float, 3>, int>(fpat)
+                     .cols({1, 3, 4, 5}).indexDir(dir);
+  assert(lammpsRows(indexed) == expected);
+  LammpsIndex idx;
+  assert(idx.load(fnames[0], true, dir));
+  assert((idx.steps == std::vector<long long>{6500, 11000}));
+  assert(idx.offsets[0] == 0 && idx.offsets[1] > 0);
+  std::ifstream side(LammpsIndex::sidecar(fnames[0], dir));
+  assert(side.good());
+  assert(lammpsRows(indexed) == expected);
+  // the index in memory is used if the sidecar can not be written
+  assert(lammpsRows(fromLammps<int, array<float, 3>, int>(fpat)
+                        .cols({1, 3, 4, 5}).indexDir(dir + "/none/none")) ==
+         expected);
+  for (const auto& it : fnames) {
+    std::remove(LammpsIndex::sidecar(it, dir).c_str());
+  }
+
+  // the atoms of a timestep that does not parse are skipped, as in the index
+  const auto bad = dir + "/bad.txt";
+  {
+    std::ofstream out(bad);
+    out << "ITEM: TIMESTEP\n7\nITEM: NUMBER OF ATOMS\n1\n"
+        << "ITEM: ATOMS id type\n1 1\n"
+        << "ITEM: TIMESTEP\nx\nITEM: NUMBER OF ATOMS\n2\n"
+        << "ITEM: ATOMS id type\n2 1\n3 1\n"
+        << "ITEM: TIMESTEP\n9\nITEM: NUMBER OF ATOMS\n1\n"
+        << "ITEM: ATOMS id type\n4 2\n";
+  }
+  auto skipped = lammpsRows(fromLammps<int, int, int>(bad));
+  assert((skipped == decltype(skipped){std::make_tuple(1, 1, 7),
+                                       std::make_tuple(4, 2, 9)}));
+  assert(idx.load(bad));
+  assert((idx.steps == std::vector<long long>{7, 9}));
+  std::remove(bad.c_str());
+  std::remove(dir.c_str());
+
+  // whole timesteps go to the processes
+  for (auto nProc = 1; nProc < 5; ++nProc) {
+    decltype(expected) all;
+    for (auto pos = 0; pos < nProc; ++pos) {
+      auto rows = lammpsRows(atoms, pos, nProc);
+      assert(rows.size() % 10 == 0);
+      all.insert(std::end(all), std::begin(rows), std::end(rows));
+    }
+    assert(all == expected);
+  }
+  assert(lammpsRows(atoms.split(false), 1, 2).size() == 30);
+
+  auto steps = lammpsRows(fromLammps<int, array<float, 3>, int>(fpat)
+                              .cols({1, 3, 4, 5}).timesteps(6000, 6500));
+  assert(steps.size() == 20);
+  for (const auto& it : steps) {
+    assert(std::get<2>(it) == 6000 || std::get<2>(it) == 6500);
+  }
+
+  // first columns by default
+  auto first = lammpsRows(fromLammps<int, int, float, int>(fnames));
+  assert(first.size() == 30);
+  assert((first[0] == std::make_tuple(2, 1, 1.51998F, 6500)));
+
+  auto none = lammpsRows(fromLammps<int, int>("data/lammps/none*.txt"));
+  assert(none.empty());
+}
+}
+}
@@ -0,0 +1,79 @@
+/*!
+ * @file
+ * Basic tests for `gatherRows.hpp` and `getAt`, `getAll` of a dataflow.
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <ezl.hpp>
+#include <ezl/algorithms/io.hpp>
+#include <ezl/helper/gatherRows.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail;
+
+void gatherRowsBatchTest();
+void getAllTest();
+
+void gatherRowsTest(int argc, char* argv[]) {
+  gatherRowsBatchTest();
+  getAllTest();
+}
+
+// small batches, so that rows of a process are sent in many rounds.
+void gatherRowsBatchTest() {
+  const auto rank = Karta::inst().rank();
+  const auto nProc = Karta::inst().nProc();
+  auto total = 0;
+  for (auto r = 0; r < nProc; ++r) total += r * 50 + 10;
+  for (auto root : {-1, 0, nProc - 1}) {
+    std::vector<std::tuple<int, std::string>> rows;
+    for (auto i = 0; i < rank * 50 + 10; ++i) {
+      rows.emplace_back(rank, std::to_string(i));
+    }
+    gatherRows(rows, root, 64);
+    if (root >= 0 && rank != root) {
+      assert(rows.empty());
+      continue;
+    }
+    assert(int(rows.size()) == total);
+    auto pos = 0;
+    for (auto r = 0; r < nProc; ++r) {
+      for (auto i = 0; i < r * 50 + 10; ++i, ++pos) {
+        assert(std::get<0>(rows[pos]) == r);
+        assert(std::get<1>(rows[pos]) == std::to_string(i));
+      }
+    }
+  }
+}
+
+void getAllTest() {
+  auto all = ezl::rise(ezl::iota(100))
+                 .map([](int i) { return i * 2; })
+                 .getAll();
+  assert(all.size() == 100);
+  std::sort(std::begin(all), std::end(all));
+  for (auto i = 0; i < 100; ++i) {
+    assert(std::get<0>(all[i]) == i && std::get<1>(all[i]) == 2 * i);
+  }
+  auto at = ezl::rise(ezl::iota(100)).getAt(0);
+  if (Karta::inst().rank() == 0) {
+    assert(at.size() == 100);
+  } else {
+    assert(at.empty());
+  }
+}
+
+}
+}
@@ -0,0 +1,136 @@
+/*!
+ * @file
+ * Basic tests for `lexCastTuple.hpp`
+ *
+ * This file is a part of easyLambda(ezl) project for parallel data
+ * processing with modern C++ and MPI.
+ *
+ * @copyright Utkarsh Bhardwaj <haptork@gmail.com> 2015-2016
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying LICENSE.md or copy at * http://boost.org/LICENSE_1_0.txt)
+ * */
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include <boost/range/iterator_range.hpp>
+
+#include <ezl/helper/meta/lexCastTuple.hpp>
+
+namespace ezl {
+namespace test {
+using namespace ezl::detail::meta;
+
+template <class T>
+bool parse(const std::string& s, T& out) {
+  return parseField(s.data(), s.data() + s.size(), out);
+}
+
+void lexCastTupleTest() {
+  using std::string;
+  using std::tuple;
+  using std::vector;
+
+  // integers
+  int i = 7;
+  assert(parse("42", i) && i == 42);
+  assert(parse("-42", i) && i == -42);
+  assert(parse("+42", i) && i == 42);
+  assert(parse("2147483647", i) && i == std::numeric_limits<int>::max());
+  assert(parse("-2147483648", i) && i == std::numeric_limits<int>::min());
+  assert(!parse("2147483648", i));
+  assert(!parse("-2147483649", i));
+  assert(!parse("", i));
+  assert(!parse("-", i));
+  assert(!parse("4.2", i));
+  assert(!parse(" 42", i));
+  assert(!parse("42a", i));
+  long long ll;
+  assert(parse("-9223372036854775808", ll) &&
+         ll == std::numeric_limits<long long>::min());
+  assert(!parse("9223372036854775808", ll));
+  unsigned u;
+  assert(parse("4294967295", u) && u == 4294967295u);
+  assert(!parse("4294967296", u));
+  assert(!parse("-1", u));
+  short sh;
+  assert(parse("-32768", sh) && sh == -32768);
+  assert(!parse("32768", sh));
+
+  // reals, compared against strtod for exact rounding
+  double d;
+  float f;
+  for (auto s : {"0", "-0", "1", "-1.5", "3.14159", ".5", "5.", "1e5", "1E-5",
+                 "-2.5e+3", "0.000123", "123456789012345678", "1e22", "1e23",
+                 "4.9406564584124654e-324", "1.7976931348623157e308",
+                 "0.1234567890123456789012345", "100000000000000000000000000",
+                 "2.2250738585072014e-308", "-73.283600", "8.589973e9"}) {
+    assert(parse(s, d) && d == std::strtod(s, nullptr));
+    if (std::isinf(std::strtof(s, nullptr))) {
+      assert(!parse(s, f));  // out of range
+    } else {
+      assert(parse(s, f) && f == std::strtof(s, nullptr));
+    }
+  }
+  assert(parse("inf", d) && std::isinf(d));
+  assert(parse("nan", d) && std::isnan(d));
+  assert(std::signbit((parse("-0.0", d), d)));
+  for (auto s : {"", "-", ".", "e5", "1e", "1e+", "1.5f", " 1", "1 ", "1..2",
+                 "1e999", "--1", "abc"}) {
+    assert(!parse(s, d));
+  }
+  std::mt19937 gen{7};
+  std::uniform_real_distribution<double> dis{-1e6, 1e6};
+  char buf[64];
+  for (auto k = 0; k < 10000; ++k) {
+    snprintf(buf, sizeof(buf), (k % 2) ? "%.6f" : "%.17g", dis(gen));
+    assert(parse(buf, d) && d == std::strtod(buf, nullptr));
+    assert(parse(buf, f) && f == std::strtof(buf, nullptr));
+  }
+
+  // others
+  string s;
+  assert(parse("a b", s) && s == "a b");
+  char c;
+  assert(parse("x", c) && c == 'x');
+  assert(!parse("xy", c));
+  bool b;
+  assert(parse("1", b) && b);
+  assert(!parse("true", b));
+
+  // tuples with arrays, from strings and from char ranges
+  vector<string> vstr{"1", "2.5", "a", "3", "4", "5"};
+  tuple<int, float, string, std::array<long, 3>> out;
+  assert(lexCastTuple(vstr, out));
+  assert(out == std::make_tuple(1, 2.5F, string("a"),
+                                std::array<long, 3>{{3, 4, 5}}));
+  const string buffer = "7 0.25 b 6 7 8";
+  vector<boost::iterator_range<const char*>> views;
+  for (auto p : {0, 2, 7, 9, 11, 13}) {
+    auto first = buffer.data() + p;
+    views.emplace_back(first, first + ((p == 2) ? 4 : 1));
+  }
+  assert(lexCastTuple(views, out));
+  assert(out == std::make_tuple(7, 0.25F, string("b"),
+                                std::array<long, 3>{{6, 7, 8}}));
+  vstr[4] = "x";
+  assert(!lexCastTuple(vstr, out));
+  vstr[4] = "";
+  assert(!lexCastTuple(vstr, out));
+  assert(lexCastTuple(vstr, out, false));
+  assert(std::get<3>(out)[1] == 0);
+  tuple<std::array<double, 2>> arr;
+  vector<string> two{"1.5", "-2"};
+  assert(lexCastTuple(two, arr) && std::get<0>(arr)[1] == -2.);
+}
+
+} // namespace test
+} // namespace ezl
@@ -6,14 +6,24 @@ namespace test {
 void slctTest();
 void slctTupleTest();
 void funcInvokeTest();
+void lexCastTupleTest();
 
 void MapTest(int, char*[]);
 void ReduceTest(int, char*[]);
 void ReduceAllTest(int, char*[]);
 void FilterTest(int, char*[]);
+void DumpTest(int, char*[]);
+void AsyncWriterTest(int, char*[]);
 void fromFileTest(int, char*[]);
+void fromBinaryTest(int, char*[]);
+void fromLammpsTest(int, char*[]);
 void MPIBridgeTest(int, char*[]);
 void RiseTest(int, char*[]);
+void RowStreamTest(int, char*[]);
+void gatherRowsTest(int, char*[]);
+void FusedTest(int, char*[]);
+void ThreadBridgeTest(int, char*[]);
+void ThreadRanksTest(int, char*[]);
 
 int ctorTeller::_ctor = 0;
 int ctorTeller::_copyCtor = 0;
@@ -25,12 +35,22 @@ int unittests(int argc, char* argv[]) {
   slctTest();
   slctTupleTest();
   funcInvokeTest();
+  lexCastTupleTest();
   MapTest(argc, argv);
   ReduceTest(argc, argv);
   ReduceAllTest(argc, argv);
   FilterTest(argc, argv);
+  DumpTest(argc, argv);
+  AsyncWriterTest(argc, argv);
   fromFileTest(argc, argv);
+  fromBinaryTest(argc, argv);
+  fromLammpsTest(argc, argv);
   RiseTest(argc, argv);
+  RowStreamTest(argc, argv);
+  gatherRowsTest(argc, argv);
+  FusedTest(argc, argv);
+  ThreadBridgeTest(argc, argv);
+  ThreadRanksTest(argc, argv);
 #ifndef NOMPI
   MPIBridgeTest(argc, argv);
 #endif
@@ -41,7 +61,7 @@ int unittests(int argc, char* argv[]) {
 }
 
 int main(int argc, char* argv[]) {
-  ezl::Env env{argc, argv, false};
+  ezl::Env env{argc, argv, false, true};  // streams run on threads
   ezl::test::unittests(argc, argv);
   return 0;
 }
\ No newline at end of file